@@ -111,8 +111,11 @@ static avl_node_t *rotate_right(avl_tree_t *tree, avl_node_t *y) {
 
 /**
  * @brief 삽입/삭제 후 노드 x부터 루트까지 올라가며 재조정
+ * @return 수행한 회전 수
  */
-static void rebalance_upwards(avl_tree_t *tree, avl_node_t *x) {
+static int rebalance_upwards(avl_tree_t *tree, avl_node_t *x) {
+    int rotations = 0;
+
     while (x != &nil_sentinel) {
         update_height(x);
         int bf = get_balance_factor(x);
@@ -122,18 +125,23 @@ static void rebalance_upwards(avl_tree_t *tree, avl_node_t *x) {
         if (bf > 1) {
             if (get_balance_factor(x->left) < 0) {
                 x->left = rotate_left(tree, x->left);
+                rotations++;
             }
             new_subtree_root = rotate_right(tree, x);
+            rotations++;
         }
         else if (bf < -1) {
             if (get_balance_factor(x->right) > 0) {
                 x->right = rotate_right(tree, x->right);
+                rotations++;
             }
             new_subtree_root = rotate_left(tree, x);
+            rotations++;
         }
         
         x = new_subtree_root->parent; // 회전 후의 부모로 이동
     }
+    return rotations;
 }
 
 /**
@@ -189,7 +197,7 @@ void avl_init(avl_tree_t *tree) {
 /**
  * @brief 트리에 새 노드 삽입 (BST 삽입 + 재조정)
  */
-void avl_insert(avl_tree_t *tree, avl_node_t *z) {
+int avl_insert(avl_tree_t *tree, avl_node_t *z) {
     avl_node_t *y = &nil_sentinel; // 삽입될 위치의 부모
     avl_node_t *x = tree->root;    // 삽입될 위치 탐색
 
@@ -219,13 +227,13 @@ void avl_insert(avl_tree_t *tree, avl_node_t *z) {
     z->height = 1; // 새 리프 노드의 높이는 1
 
     // 3. 부모(y)부터 루트까지 올라가며 높이 갱신 및 재조정
-    rebalance_upwards(tree, y);
+    return rebalance_upwards(tree, y);
 }
 
 /**
  * @brief 트리에서 노드 삭제 (BST 삭제 + 재조정)
  */
-void avl_delete(avl_tree_t *tree, avl_node_t *z) {
+int avl_delete(avl_tree_t *tree, avl_node_t *z) {
     avl_node_t *y; // 실제로 트리에서 '제거'될 노드 (z 또는 z의 후계자)
     avl_node_t *x; // y의 자리를 '대체'할 노드 (y의 자식 중 하나)
 
@@ -269,7 +277,7 @@ void avl_delete(avl_tree_t *tree, avl_node_t *z) {
     }
 
     // 2. 재조정 시작점(x의 부모)부터 루트까지 올라가며 재조정
-    rebalance_upwards(tree, rebalance_start_node);
+    return rebalance_upwards(tree, rebalance_start_node);
 }
 
 /**
@@ -41,15 +41,17 @@ void avl_init(avl_tree_t *tree);
  * @brief 트리에 새 노드를 삽입하고 재조정합니다.
  * @param tree 트리 포인터
  * @param node 삽입할 노드 (size, left, right, parent, height는 내부에서 설정됨)
+ * @return 재조정에 쓴 회전 수
  */
-void avl_insert(avl_tree_t *tree, avl_node_t *node);
+int avl_insert(avl_tree_t *tree, avl_node_t *node);
 
 /**
  * @brief 트리에서 특정 노드를 삭제하고 재조정합니다.
  * @param tree 트리 포인터
  * @param node 삭제할 노드 포인터
+ * @return 재조정에 쓴 회전 수
  */
-void avl_delete(avl_tree_t *tree, avl_node_t *node);
+int avl_delete(avl_tree_t *tree, avl_node_t *node);
 
 /**
  * @brief Best-fit으로 노드를 검색합니다.
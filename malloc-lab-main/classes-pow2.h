@@ -0,0 +1,17 @@
+/*
+ * Power-of-two size classes: 16, 32, 64, ..., 4096.
+ * The list index is a single count-leading-zeros, no table.
+ *
+ * Class upper limits: 16, 32, 64, 128, 256, 512, 1024, 2048, 4096
+ */
+#ifndef MM_CLASSES_H
+#define MM_CLASSES_H
+
+#define SMALL_BLOCK_MAX 4096
+#define NUM_SEG_LISTS   10   /* 9 classes + the avl slot */
+
+/* ceil(log2(size)) - 4 for size > 16 */
+#define SEG_INDEX(size) ((size) > SMALL_BLOCK_MAX ? NUM_SEG_LISTS - 1 : \
+                     (size) <= 16 ? 0 : 28 - __builtin_clz((unsigned)(size) - 1))
+
+#endif /* MM_CLASSES_H */
@@ -34,6 +34,14 @@
   "realloc-bal.rep",\
   "realloc2-bal.rep"
 
+/*
+ * Tracefiles in TRACEDIR for the region comparison (-R). Every object
+ * in these traces dies at the end of its request, so the driver can
+ * replay them against the mm_region bump-pointer allocator as well.
+ */
+#define REGION_TRACEFILES \
+  "region-bal.rep"
+
 /*
  * This constant gives the estimated performance of the libc malloc
  * package using our traces on some reference system, typically the
@@ -67,6 +75,8 @@
  *****************************************************************************/
 #define USE_FCYC   0   /* cycle counter w/K-best scheme (x86 & Alpha only) */
 #define USE_ITIMER 0   /* interval timer (any Unix box) */
-#define USE_GETTOD 1   /* gettimeofday (any Unix box) */
+#define USE_GETTOD 0   /* gettimeofday (any Unix box) */
+#define USE_MONO   1   /* clock_gettime(CLOCK_MONOTONIC_RAW), auto-scaled reps */
+#define USE_RDTSCP 0   /* calibrated rdtscp counter, auto-scaled reps (x86) */
 
 #endif /* __CONFIG_H */
@@ -36,6 +36,12 @@ void init_fsecs(void)
 #elif USE_GETTOD
     if (verbose)
 	printf("Measuring performance with gettimeofday().\n");
+#elif USE_MONO
+    if (verbose)
+	printf("Measuring performance with clock_gettime(CLOCK_MONOTONIC_RAW).\n");
+#elif USE_RDTSCP
+    if (verbose)
+	printf("Measuring performance with a calibrated rdtscp counter.\n");
 #endif
 }
 
@@ -51,6 +57,10 @@ double fsecs(fsecs_test_funct f, void *argp)
     return ftimer_itimer(f, argp, 10);
 #elif USE_GETTOD
     return ftimer_gettod(f, argp, 10);
+#elif USE_MONO
+    return ftimer_autoscale(ftimer_monotonic, f, argp);
+#elif USE_RDTSCP
+    return ftimer_autoscale(ftimer_rdtscp, f, argp);
 #endif 
 }
 
@@ -7,11 +7,30 @@
  * Function timers that estimate the running time (in seconds) of a function f.
  *    ftimer_itimer: version that uses the interval timer
  *    ftimer_gettod: version that uses gettimeofday
+ *    ftimer_monotonic: version that uses clock_gettime(CLOCK_MONOTONIC_RAW)
+ *    ftimer_rdtscp: version that uses the calibrated rdtscp counter
+ *    ftimer_autoscale: picks a repetition count for one of the above
  */
 #include <stdio.h>
 #include <sys/time.h>
+#include <time.h>
 #include "ftimer.h"
 
+/* CLOCK_MONOTONIC_RAW is Linux-only; plain monotonic elsewhere */
+#ifdef CLOCK_MONOTONIC_RAW
+#define FTIMER_CLOCK CLOCK_MONOTONIC_RAW
+#else
+#define FTIMER_CLOCK CLOCK_MONOTONIC
+#endif
+
+/* Parameters for ftimer_autoscale */
+#define FTIMER_MIN_SECS 0.01   /* shortest batch we trust */
+#define FTIMER_BATCHES  3      /* batches to take the best of */
+#define FTIMER_MAX_REPS (1<<20)
+
+/* Time stamp counter calibration window */
+#define TSC_CALIBRATE_SECS 0.02
+
 /* function prototypes */
 static void init_etime(void);
 static double get_etime(void);
@@ -53,6 +72,105 @@ double ftimer_gettod(ftimer_test_funct f, void *argp, int n)
 }
 
 
+/* mono_secs - current CLOCK_MONOTONIC_RAW time in seconds */
+static double mono_secs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(FTIMER_CLOCK, &ts);
+    return ts.tv_sec + 1E-9*ts.tv_nsec;
+}
+
+/* 
+ * ftimer_monotonic - Use clock_gettime(CLOCK_MONOTONIC_RAW) to estimate
+ * the running time of f(argp). Return the average of n runs.  
+ */
+double ftimer_monotonic(ftimer_test_funct f, void *argp, int n)
+{
+    int i;
+    double start;
+
+    start = mono_secs();
+    for (i = 0; i < n; i++) 
+	f(argp);
+    return (mono_secs() - start) / n;
+}
+
+#if defined(__i386__) || defined(__x86_64__)
+/*
+ * Routines for the rdtscp time stamp counter. rdtscp waits for earlier
+ * instructions to finish, so the timed region can't leak past the read.
+ */
+static double tsc_hz = 0;   /* calibrated ticks per second */
+
+static unsigned long long read_tsc(void)
+{
+    unsigned hi, lo, aux;
+
+    asm volatile("rdtscp" : "=a" (lo), "=d" (hi), "=c" (aux));
+    return ((unsigned long long)hi << 32) | lo;
+}
+
+/* calibrate the counter against CLOCK_MONOTONIC_RAW */
+static void calibrate_tsc(void)
+{
+    double start, secs;
+    unsigned long long t0;
+
+    start = mono_secs();
+    t0 = read_tsc();
+    while ((secs = mono_secs() - start) < TSC_CALIBRATE_SECS)
+	;
+    tsc_hz = (read_tsc() - t0) / secs;
+}
+
+/* 
+ * ftimer_rdtscp - Use the calibrated time stamp counter to estimate
+ * the running time of f(argp). Return the average of n runs.  
+ */
+double ftimer_rdtscp(ftimer_test_funct f, void *argp, int n)
+{
+    int i;
+    unsigned long long start;
+
+    if (tsc_hz == 0)
+	calibrate_tsc();
+    start = read_tsc();
+    for (i = 0; i < n; i++) 
+	f(argp);
+    return (read_tsc() - start) / tsc_hz / n;
+}
+#else
+double ftimer_rdtscp(ftimer_test_funct f, void *argp, int n)
+{
+    return ftimer_monotonic(f, argp, n);
+}
+#endif
+
+/* 
+ * ftimer_autoscale - Double n until one batch of n runs takes at least
+ * FTIMER_MIN_SECS, then return the best per-run average of
+ * FTIMER_BATCHES batches of n runs.
+ */
+double ftimer_autoscale(ftimer_funct timer, ftimer_test_funct f, void *argp)
+{
+    int i, n = 1;
+    double t, best;
+
+    best = timer(f, argp, n);
+    while (best * n < FTIMER_MIN_SECS && n < FTIMER_MAX_REPS) {
+	n *= 2;
+	best = timer(f, argp, n);
+    }
+    for (i = 1; i < FTIMER_BATCHES; i++) {
+	t = timer(f, argp, n);
+	if (t < best)
+	    best = t;
+    }
+    return best;
+}
+
+
 /*
  * Routines for manipulating the Unix interval timer
  */
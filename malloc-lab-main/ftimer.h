@@ -12,3 +12,22 @@ double ftimer_itimer(ftimer_test_funct f, void *argp, int n);
    Return the average of n runs */
 double ftimer_gettod(ftimer_test_funct f, void *argp, int n);
 
+/* Estimate the running time of f(argp) using clock_gettime with
+   CLOCK_MONOTONIC_RAW (ns resolution, immune to clock adjustments).
+   Return the average of n runs */
+double ftimer_monotonic(ftimer_test_funct f, void *argp, int n);
+
+/* Estimate the running time of f(argp) using the rdtscp time stamp
+   counter, calibrated against CLOCK_MONOTONIC_RAW on first use.
+   Falls back to ftimer_monotonic off x86. Return the average of n runs */
+double ftimer_rdtscp(ftimer_test_funct f, void *argp, int n);
+
+/* One of the timers above, as passed to ftimer_autoscale */
+typedef double (*ftimer_funct)(ftimer_test_funct f, void *argp, int n);
+
+/* Time f(argp) with timer, doubling the repetition count until one batch
+   runs for at least FTIMER_MIN_SECS, then return the smallest per-run
+   average over FTIMER_BATCHES such batches. Short traces get enough
+   repetitions to rise well above timer resolution and noise. */
+double ftimer_autoscale(ftimer_funct timer, ftimer_test_funct f, void *argp);
+
@@ -0,0 +1,111 @@
+#!/usr/bin/perl
+
+# gen_classes.pl - Generate a size-class header for mm.c (see mm_config.h)
+#
+#   gen_classes.pl -l 16,32,64,...,3072 > classes-default.h
+#       classes with the given upper block-size limits
+#   gen_classes.pl -n 12 [-m 3072] traces/*-bal.rep > classes-trace.h
+#       n classes whose limits split the trace requests up to -m bytes
+#       into groups of equal count, so each free list sees about the
+#       same traffic
+#
+# The header defines SMALL_BLOCK_MAX, NUM_SEG_LISTS and SEG_INDEX(size),
+# which maps an aligned block size to its list with a single load from
+# a lookup table indexed by (size-1)/8.
+
+use Getopt::Std;
+
+$DSIZE = 8;            # alignment and header+footer overhead in mm.c
+$MIN_BLOCK = 16;       # smallest block mm.c makes
+
+getopts('l:n:m:') or die "usage: $0 -l <limits> | -n <classes> [-m <max>] <traces>\n";
+
+if ($opt_l) {
+    @limits = split /,/, $opt_l;
+    $how = "-l $opt_l";
+}
+elsif ($opt_n) {
+    $max = $opt_m ? $opt_m : 3072;
+    @limits = profile_limits($opt_n, $max, @ARGV);
+    $how = "-n $opt_n -m $max " . join(" ", @ARGV);
+}
+else {
+    die "usage: $0 -l <limits> | -n <classes> [-m <max>] <traces>\n";
+}
+
+# Limits must be increasing multiples of DSIZE, starting at MIN_BLOCK or above
+for ($i = 0; $i <= $#limits; $i++) {
+    die "limit $limits[$i] is not a multiple of $DSIZE\n" if $limits[$i] % $DSIZE;
+    die "limit $limits[$i] is below $MIN_BLOCK\n" if $limits[$i] < $MIN_BLOCK;
+    die "limits must increase\n" if $i > 0 && $limits[$i] <= $limits[$i-1];
+}
+$max = $limits[$#limits];
+$num_classes = @limits;
+
+# One table entry per DSIZE step of block size
+@lut = ();
+$class = 0;
+for ($i = 0; $i < $max / $DSIZE; $i++) {
+    $size = ($i + 1) * $DSIZE;
+    $class++ while $size > $limits[$class];
+    push @lut, $class;
+}
+
+print "/*\n";
+print " * Generated by gen_classes.pl $how\n";
+print " * Do not edit; rerun the generator instead.\n";
+print " *\n";
+print " * Class upper limits: " . join(", ", @limits) . "\n";
+print " */\n";
+print "#ifndef MM_CLASSES_H\n";
+print "#define MM_CLASSES_H\n\n";
+print "#define SMALL_BLOCK_MAX $max\n";
+print "#define NUM_SEG_LISTS   " . ($num_classes + 1) . "   /* $num_classes classes + the avl slot */\n\n";
+print "static const unsigned char seg_index_lut[SMALL_BLOCK_MAX/8] = {\n";
+for ($i = 0; $i <= $#lut; $i += 16) {
+    $end = $i + 15 < $#lut ? $i + 15 : $#lut;
+    print "    " . join(", ", @lut[$i..$end]) . ($end < $#lut ? ",\n" : "\n");
+}
+print "};\n\n";
+print "#define SEG_INDEX(size) ((size) > SMALL_BLOCK_MAX ? NUM_SEG_LISTS - 1 : \\\n";
+print "                     seg_index_lut[((size) - 1) >> 3])\n\n";
+print "#endif /* MM_CLASSES_H */\n";
+
+# Block size mm.c uses for a request of $size bytes
+sub block_size {
+    my ($size) = @_;
+    my $asize = int(($size + $DSIZE + $DSIZE - 1) / $DSIZE) * $DSIZE;
+    return $asize < $MIN_BLOCK ? $MIN_BLOCK : $asize;
+}
+
+# Limits that split the small requests in the traces into $n
+# groups of about equal count
+sub profile_limits {
+    my ($n, $max, @files) = @_;
+    my (%count, $total, @sizes, @lims, $acc, $want, $s);
+
+    die "no trace files given\n" unless @files;
+    foreach $file (@files) {
+        open TRACE, "<$file" or die "Cannot open $file\n";
+        <TRACE> for 1..4;   # header lines
+        while (<TRACE>) {
+            next unless /^[ar]\s+\d+\s+(\d+)/;
+            $s = block_size($1);
+            next if $s > $max;
+            $count{$s}++;
+            $total++;
+        }
+        close TRACE;
+    }
+    die "no requests of $max bytes or less\n" unless $total;
+
+    @sizes = sort { $a <=> $b } keys %count;
+    $acc = 0;
+    foreach $s (@sizes) {
+        $acc += $count{$s};
+        $want = $total * (@lims + 1) / $n;
+        push @lims, $s if $acc >= $want && @lims < $n - 1;
+    }
+    push @lims, $max if !@lims || $lims[$#lims] < $max;
+    return @lims;
+}
@@ -0,0 +1,38 @@
+/*
+ * heapdump.h - Binary heap snapshot format written by mm_dump_heap
+ *     (mdriver -D) and read back by heapview.
+ *
+ * A dump file is a sequence of snapshots. Each snapshot is one
+ * heapdump_hdr_t followed by nblocks heapdump_blk_t records in address
+ * order, from the first block after the prologue up to the epilogue.
+ * All fields are in host byte order.
+ */
+#ifndef HEAPDUMP_H
+#define HEAPDUMP_H
+
+#include <stdint.h>
+
+#define HEAPDUMP_MAGIC   0x504d4448u  /* "HDMP" */
+#define HEAPDUMP_VERSION 1
+
+/* Values of heapdump_blk_t.bin other than a segregated list index */
+#define HEAPDUMP_BIN_AVL   0xfe  /* free block held in the AVL tree */
+#define HEAPDUMP_BIN_ALLOC 0xff  /* allocated block */
+
+typedef struct {
+    uint32_t magic;      /* HEAPDUMP_MAGIC */
+    uint32_t version;    /* HEAPDUMP_VERSION */
+    uint32_t opnum;      /* trace requests completed before the snapshot */
+    uint32_t heapsize;   /* bytes from mem_heap_lo to the brk */
+    uint32_t nblocks;    /* heapdump_blk_t records that follow */
+} heapdump_hdr_t;
+
+typedef struct {
+    uint32_t offset;     /* offset of the block header from mem_heap_lo */
+    uint32_t size;       /* block size, header and footer included */
+    uint8_t alloc;       /* 1 if allocated */
+    uint8_t bin;         /* seg list index, HEAPDUMP_BIN_AVL or _ALLOC */
+    uint8_t pad[2];
+} heapdump_blk_t;
+
+#endif /* HEAPDUMP_H */
@@ -0,0 +1,318 @@
+/*
+ * heapview.c - Render heap snapshots written by mdriver -D.
+ *
+ * For every snapshot in a dump file, prints a summary (allocated and
+ * free bytes, largest hole, external fragmentation), a histogram of
+ * hole sizes, the occupancy of each free structure, the small
+ * allocated blocks that keep the largest free spans apart, and a text
+ * heat map of the heap. With -p it also writes each snapshot as a PGM
+ * image, one pixel per -g bytes, white for free and black for
+ * allocated.
+ *
+ * Usage: heapview [-w <cols>] [-r <rows>] [-n <top>] [-s <bytes>]
+ *                 [-p <prefix>] [-g <bytes>] <file.heap>
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "heapdump.h"
+
+#define MAXLINE   1024
+#define NUM_HIST    32  /* power-of-two hole size buckets */
+#define NUM_BINS   256  /* possible values of heapdump_blk_t.bin */
+
+/* Settings from the command line */
+static int cols = 64;          /* heat map width in characters */
+static int rows = 16;          /* heat map height in characters */
+static int top = 10;           /* pinning blocks to list */
+static size_t pin_max = 64;    /* largest block counted as pinning */
+static char *pgm_prefix = NULL; /* write PGM images with this prefix */
+static size_t pgm_gran = 64;   /* bytes per PGM pixel */
+
+/* A small allocated block and the free span it splits */
+typedef struct {
+    uint32_t offset;    /* the allocated block */
+    uint32_t size;
+    uint32_t span;      /* free bytes it would join with if freed */
+} pin_t;
+
+static void app_error(char *msg)
+{
+    printf("%s\n", msg);
+    exit(1);
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: heapview [-w <cols>] [-r <rows>] [-n <top>] [-s <bytes>]\n"
+	    "                [-p <prefix>] [-g <bytes>] <file.heap>\n");
+    fprintf(stderr, "\t-w <cols>    Heat map width (default 64).\n");
+    fprintf(stderr, "\t-r <rows>    Heat map height (default 16).\n");
+    fprintf(stderr, "\t-n <top>     Pinning blocks to list (default 10).\n");
+    fprintf(stderr, "\t-s <bytes>   Largest block counted as pinning (default 64).\n");
+    fprintf(stderr, "\t-p <prefix>  Also write <prefix>-<k>.pgm per snapshot.\n");
+    fprintf(stderr, "\t-g <bytes>   Heap bytes per PGM pixel (default 64).\n");
+}
+
+/*
+ * alloc_cells - Count the allocated bytes that fall into each of ncells
+ *    equal slices of the heap
+ */
+static double *alloc_cells(heapdump_hdr_t *hdr, heapdump_blk_t *blks,
+			   size_t ncells, double *gran)
+{
+    double *cells, lo, hi, c0;
+    size_t c;
+    uint32_t i;
+
+    if ((cells = calloc(ncells, sizeof(double))) == NULL)
+	app_error("calloc failed in alloc_cells");
+    *gran = (double)hdr->heapsize / ncells;
+    for (i = 0; i < hdr->nblocks; i++) {
+	if (!blks[i].alloc)
+	    continue;
+	lo = blks[i].offset;
+	hi = lo + blks[i].size;
+	for (c = (size_t)(lo / *gran); c < ncells && c * *gran < hi; c++) {
+	    c0 = c * *gran;
+	    cells[c] += (hi < c0 + *gran ? hi : c0 + *gran) - (lo > c0 ? lo : c0);
+	}
+    }
+    return cells;
+}
+
+/*
+ * print_map - Text heat map: '.' for a free slice, '#' for a full one,
+ *    and 1-9 for the allocated tenths in between
+ */
+static void print_map(heapdump_hdr_t *hdr, heapdump_blk_t *blks)
+{
+    double *cells, gran, f;
+    int r, c;
+
+    cells = alloc_cells(hdr, blks, (size_t)rows * cols, &gran);
+    printf("  Heap map (%.0f bytes per char; '.' free, 1-9 tenths allocated, '#' full):\n",
+	   gran);
+    for (r = 0; r < rows; r++) {
+	printf("  |");
+	for (c = 0; c < cols; c++) {
+	    f = cells[r*cols + c] / gran;
+	    if (f <= 0)
+		putchar('.');
+	    else if (f >= 1 - 1e-6) /* slices are fractional byte counts */
+		putchar('#');
+	    else
+		putchar('1' + (int)(f * 9));
+	}
+	printf("|\n");
+    }
+    free(cells);
+}
+
+/*
+ * write_pgm - Write a snapshot as a binary PGM image, pgm_gran heap
+ *    bytes per pixel, 256 pixels wide
+ */
+static void write_pgm(heapdump_hdr_t *hdr, heapdump_blk_t *blks, int k)
+{
+    char path[MAXLINE];
+    FILE *fp;
+    double *cells, gran;
+    size_t i, ncells, width = 256, height;
+
+    ncells = (hdr->heapsize + pgm_gran - 1) / pgm_gran;
+    height = (ncells + width - 1) / width;
+    ncells = width * height;
+    cells = alloc_cells(hdr, blks, ncells, &gran);
+
+    sprintf(path, "%s-%d.pgm", pgm_prefix, k);
+    if ((fp = fopen(path, "wb")) == NULL)
+	app_error("could not open PGM output file");
+    fprintf(fp, "P5\n%lu %lu\n255\n", (unsigned long)width, (unsigned long)height);
+    for (i = 0; i < ncells; i++)
+	fputc(255 - (int)(255 * (cells[i] / gran) + 0.5), fp);
+    fclose(fp);
+    free(cells);
+    printf("  Wrote %s\n", path);
+}
+
+static int pin_cmp(const void *a, const void *b)
+{
+    const pin_t *pa = a, *pb = b;
+
+    return (pa->span < pb->span) - (pa->span > pb->span);
+}
+
+/*
+ * print_pins - List small allocated blocks that sit next to free
+ *    space, largest span first. Freeing or moving such a block would
+ *    coalesce the free blocks on both sides into one hole.
+ */
+static void print_pins(heapdump_hdr_t *hdr, heapdump_blk_t *blks,
+		       uint32_t largest)
+{
+    pin_t *pins;
+    uint32_t i, span;
+    int n = 0, k;
+
+    if ((pins = malloc(hdr->nblocks * sizeof(pin_t) + 1)) == NULL)
+	app_error("malloc failed in print_pins");
+    for (i = 0; i < hdr->nblocks; i++) {
+	if (!blks[i].alloc || blks[i].size > pin_max)
+	    continue;
+	span = 0;
+	if (i > 0 && !blks[i-1].alloc)
+	    span += blks[i-1].size;
+	if (i + 1 < hdr->nblocks && !blks[i+1].alloc)
+	    span += blks[i+1].size;
+	if (span == 0)
+	    continue;
+	pins[n].offset = blks[i].offset;
+	pins[n].size = blks[i].size;
+	pins[n].span = span + blks[i].size;
+	n++;
+    }
+    qsort(pins, n, sizeof(pin_t), pin_cmp);
+
+    printf("  Pinning blocks (allocated, <= %lu bytes, next to free space): %d\n",
+	   (unsigned long)pin_max, n);
+    for (k = 0; k < n && k < top; k++)
+	printf("    offset %8u  size %6u  frees a %8u byte hole%s\n",
+	       pins[k].offset, pins[k].size, pins[k].span,
+	       pins[k].span > largest ? " (> largest)" : "");
+    free(pins);
+}
+
+/*
+ * print_snapshot - Summary statistics, histogram, free structure
+ *    occupancy, pinning blocks and heat map for one snapshot
+ */
+static void print_snapshot(heapdump_hdr_t *hdr, heapdump_blk_t *blks, int k)
+{
+    uint32_t i, largest = 0;
+    double alloc = 0, free_bytes = 0;
+    int nalloc = 0, nfree = 0, b, maxcount = 0;
+    int hist[NUM_HIST] = {0};
+    int bin_count[NUM_BINS] = {0};
+    double bin_bytes[NUM_BINS] = {0};
+    char label[MAXLINE];
+
+    for (i = 0; i < hdr->nblocks; i++) {
+	if (blks[i].alloc) {
+	    alloc += blks[i].size;
+	    nalloc++;
+	    continue;
+	}
+	free_bytes += blks[i].size;
+	nfree++;
+	if (blks[i].size > largest)
+	    largest = blks[i].size;
+	for (b = 0; b < NUM_HIST - 1 && (2u << b) <= blks[i].size; b++)
+	    ;
+	hist[b]++;
+	bin_count[blks[i].bin]++;
+	bin_bytes[blks[i].bin] += blks[i].size;
+    }
+
+    printf("Snapshot %d: before op %u, heap %u bytes, %u blocks\n",
+	   k, hdr->opnum, hdr->heapsize, hdr->nblocks);
+    printf("  Allocated %.0f bytes in %d blocks, free %.0f bytes in %d blocks\n",
+	   alloc, nalloc, free_bytes, nfree);
+    printf("  Largest hole %u bytes, external fragmentation %.1f%%\n",
+	   largest, free_bytes > 0 ? 100.0 * (1 - largest / free_bytes) : 0.0);
+
+    /* Hole size histogram, bucket b holding sizes in [2^b, 2^(b+1)) */
+    for (b = 0; b < NUM_HIST; b++)
+	if (hist[b] > maxcount)
+	    maxcount = hist[b];
+    if (maxcount > 0)
+	printf("  Hole sizes:\n");
+    for (b = 0; b < NUM_HIST; b++) {
+	if (hist[b] == 0)
+	    continue;
+	sprintf(label, "%u-%u", 1u << b, (2u << b) - 1);
+	printf("    %-14s%7d  ", label, hist[b]);
+	for (i = 0; i < (uint32_t)(40 * hist[b] / maxcount) + 1; i++)
+	    putchar('*');
+	putchar('\n');
+    }
+
+    /* Occupancy of the free structures */
+    if (nfree > 0)
+	printf("  Free structures:\n");
+    for (b = 0; b < NUM_BINS; b++) {
+	if (bin_count[b] == 0)
+	    continue;
+	if (b == HEAPDUMP_BIN_AVL)
+	    sprintf(label, "avl tree");
+	else
+	    sprintf(label, "seg list %d", b);
+	printf("    %-14s%7d blocks %10.0f bytes\n", label, bin_count[b], bin_bytes[b]);
+    }
+
+    print_pins(hdr, blks, largest);
+    print_map(hdr, blks);
+    if (pgm_prefix)
+	write_pgm(hdr, blks, k);
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    FILE *fp;
+    heapdump_hdr_t hdr;
+    heapdump_blk_t *blks;
+    int c, k = 0;
+
+    while ((c = getopt(argc, argv, "w:r:n:s:p:g:h")) != EOF) {
+	switch (c) {
+	case 'w':
+	    cols = atoi(optarg);
+	    break;
+	case 'r':
+	    rows = atoi(optarg);
+	    break;
+	case 'n':
+	    top = atoi(optarg);
+	    break;
+	case 's':
+	    pin_max = atol(optarg);
+	    break;
+	case 'p':
+	    pgm_prefix = optarg;
+	    break;
+	case 'g':
+	    pgm_gran = atol(optarg);
+	    break;
+	case 'h':
+	    usage();
+	    exit(0);
+	default:
+	    usage();
+	    exit(1);
+	}
+    }
+    if (optind != argc - 1 || cols < 1 || rows < 1 || pgm_gran < 1) {
+	usage();
+	exit(1);
+    }
+    if ((fp = fopen(argv[optind], "rb")) == NULL)
+	app_error("could not open heap dump file");
+
+    while (fread(&hdr, sizeof(hdr), 1, fp) == 1) {
+	if (hdr.magic != HEAPDUMP_MAGIC || hdr.version != HEAPDUMP_VERSION)
+	    app_error("not a heap dump, or a different format version");
+	if ((blks = malloc(hdr.nblocks * sizeof(heapdump_blk_t) + 1)) == NULL)
+	    app_error("malloc failed in main");
+	if (fread(blks, sizeof(heapdump_blk_t), hdr.nblocks, fp) != hdr.nblocks)
+	    app_error("truncated heap dump");
+	print_snapshot(&hdr, blks, k++);
+	free(blks);
+    }
+    fclose(fp);
+    if (k == 0)
+	app_error("empty heap dump");
+    exit(0);
+}
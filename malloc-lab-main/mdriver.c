@@ -7,6 +7,7 @@
  * Copyright (c) 2002, R. Bryant and D. O'Hallaron, All rights reserved.
  * May not be used, modified, or copied without permission.
  */
+#define _GNU_SOURCE     /* for sched_setaffinity (-j) */
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -15,10 +16,17 @@
 #include <assert.h>
 #include <float.h>
 #include <time.h>
+#include <math.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
 
 #include "mm.h"
 #include "memlib.h"
+#include "region.h"
 #include "fsecs.h"
+#include "perfctr.h"
+#include "heapdump.h"
 #include "config.h"
 
 /**********************
@@ -29,6 +37,9 @@
 #define MAXLINE     1024 /* max string size */
 #define HDRLINES       4 /* number of header lines in a trace file */
 #define LINENUM(i) (i+5) /* cnvt trace request nums to linenums (origin 1) */
+#define MAXBATCH      64 /* max requests replayed by one batch call (-b) */
+#define COMPARE_RUNS   5 /* default timed runs per trace with -c */
+#define UTIL_TOLERANCE 0.005 /* util drop treated as a regression (-c) */
 
 /* Returns true if p is ALIGNMENT-byte aligned */
 #define IS_ALIGNED(p)  ((((unsigned int)(p)) % ALIGNMENT) == 0)
@@ -49,6 +60,7 @@ typedef struct {
     enum {ALLOC, FREE, REALLOC} type; /* type of request */
     int index;                        /* index for free() to use later */
     int size;                         /* byte size of alloc/realloc request */
+    int batch;                        /* length of batchable run from here */
 } traceop_t;
 
 /* Holds the information for one trace file*/
@@ -60,8 +72,28 @@ typedef struct {
     traceop_t *ops;      /* array of requests */
     char **blocks;       /* array of ptrs returned by malloc/realloc... */
     size_t *block_sizes; /* ... and a corresponding array of payload sizes */
+    char *name;          /* trace file name (names -D dump files) */
 } trace_t;
 
+/* Result of validating one trace in a -j worker process */
+typedef struct {
+    int tracenum;    /* which trace */
+    int valid;       /* was the trace processed correctly? */
+    int errors;      /* malloc_error calls made by the worker */
+    double util;     /* space utilization */
+    double heap;     /* heap size in bytes after the util run */
+} workres_t;
+
+/* One trace's results as read back from a -J file (for -c) */
+typedef struct {
+    char trace[MAXLINE]; /* trace file name */
+    int valid;           /* was the trace processed correctly? */
+    double util;         /* space utilization */
+    double kops;         /* mean throughput */
+    double kops_sd;      /* sample standard deviation of the throughput */
+    int runs;            /* number of timed runs behind kops */
+} baseline_t;
+
 /* 
  * Holds the params to the xxx_speed functions, which are timed by fcyc. 
  * This struct is necessary because fcyc accepts only a pointer array
@@ -82,6 +114,15 @@ typedef struct {
     /* defined only for the student malloc package */
     double util;     /* space utilization for this trace (always 0 for libc) */
 
+    /* hardware counts for one untimed replay (-P), -1 if unavailable */
+    double ctrs[PERFCTR_NUM];
+
+    /* spread over repeated timed runs (-n), for -J/-C/-c */
+    double kops;     /* mean throughput over the timed runs */
+    double kops_sd;  /* sample standard deviation of that throughput */
+    int runs;        /* number of timed runs */
+    double heap;     /* heap size in bytes after the util run (peak brk) */
+
     /* Note: secs and util are only defined if valid is true */
 } stats_t; 
 
@@ -90,6 +131,12 @@ typedef struct {
  *******************/
 int verbose = 0;        /* global flag for verbose output */
 static int errors = 0;  /* number of errs found when running student malloc */
+static int batch_mode = 0; /* replay runs with mm_*_batch calls (-b) */
+static int perf_mode = 0;  /* report hardware counters per op (-P) */
+static int num_runs = 0;   /* timed runs per trace (-n, 0 until set) */
+static int *dump_ops = NULL; /* sorted op indices to snapshot the heap at (-D) */
+static int num_dump_ops = 0;
+static int counters_mode = 0; /* print mm event counters (-S) */
 char msg[MAXLINE];      /* for whenever we need to compose an error message */
 
 /* Directory where default tracefiles are found */
@@ -100,6 +147,11 @@ static char *default_tracefiles[] = {
     DEFAULT_TRACEFILES, NULL
 };
 
+/* The filenames of the tracefiles for the region comparison (-R) */
+static char *region_tracefiles[] = {  
+    REGION_TRACEFILES, NULL
+};
+
 
 /********************* 
  * Function prototypes 
@@ -124,20 +176,61 @@ static void eval_libc_speed(void *ptr);
 static int eval_mm_valid(trace_t *trace, int tracenum, range_t **ranges);
 static double eval_mm_util(trace_t *trace, int tracenum, range_t **ranges);
 static void eval_mm_speed(void *ptr);
+static int mm_batch_op(trace_t *trace, int i);
+
+/* Routines for evaluating the mm_region bump-pointer allocator (-R) */
+static int eval_region_valid(trace_t *trace, int tracenum, range_t **ranges);
+static double eval_region_util(trace_t *trace);
+static void eval_region_speed(void *ptr);
+static void *region_realloc(mm_region_t *region, char *oldp, 
+			    size_t oldsize, size_t size);
 
 /* Various helper routines */
 static void printresults(int n, stats_t *stats);
+static void count_speed(fsecs_test_funct f, void *argp, stats_t *stats);
+static void time_speed(fsecs_test_funct f, void *argp, stats_t *stats);
+static long minor_faults(void);
 static void usage(void);
 static void unix_error(char *msg);
 static void malloc_error(int tracenum, int opnum, char *msg);
 static void app_error(char *msg);
 
+/* Machine-readable results (-J, -C) and regression checks (-c) */
+static void write_json(char *file, char **tracefiles, int n, 
+		       stats_t *stats, double perfindex);
+static void write_csv(char *file, char **tracefiles, int n, stats_t *stats);
+static baseline_t *read_baseline(char *file, int *n);
+static char *json_field(char *obj, char *key);
+static int compare_results(char *file, char **tracefiles, int n, 
+			   stats_t *stats);
+static double t_crit95(double df);
+
+/* Parallel validation in worker processes and pinned timing (-j) */
+static void eval_mm_parallel(char **tracefiles, int n, stats_t *stats, 
+			     int jobs);
+static void parallel_result(stats_t *stats, workres_t *res);
+static void eval_mm_worker(char *tracefile, int tracenum, int fd);
+static void pin_timing_cpu(void);
+
+/* First-fit vs bounded best-of-K in the segregated lists (-F) */
+static void eval_mm_fit(char **tracefiles, int n, stats_t *stats, int k);
+static void print_fit_compare(char **tracefiles, int n, stats_t *first, 
+			      stats_t *bestk, int k);
+
+/* Heap snapshots during the utilization replay (-D) */
+static void parse_dump_ops(char *list);
+static FILE *open_dump(char *tracename);
+static void dump_heap_at(FILE *fp, int opnum, int *next);
+
+/* mm event counters over the utilization replays (-S) */
+static void print_counters(mm_stats_t *counts, double ops);
+
 /**************
  * Main routine
  **************/
 int main(int argc, char **argv)
 {
-    int i;
+    int i, j;
     char c;
     char **tracefiles = NULL;  /* null-terminated array of trace file names */
     int num_tracefiles = 0;    /* the number of traces in that array */
@@ -145,11 +238,28 @@ int main(int argc, char **argv)
     range_t *ranges = NULL;    /* keeps track of block extents for one trace */
     stats_t *libc_stats = NULL;/* libc stats for each trace */
     stats_t *mm_stats = NULL;  /* mm (i.e. student) stats for each trace */
+    stats_t *region_stats = NULL; /* mm_region stats for each trace */
+    stats_t *first_stats = NULL;  /* mm stats with first-fit (-F) */
+    stats_t *bestk_stats = NULL;  /* mm stats with best-of-K fit (-F) */
+    mm_stats_t counts, before, after; /* mm event counters (-S) */
+    double counted_ops = 0;    /* trace ops replayed while counting */
     speed_t speed_params;      /* input parameters to the xx_speed routines */ 
 
     int team_check = 1;  /* If set, check team structure (reset by -a) */
     int run_libc = 0;    /* If set, run libc malloc (set by -l) */
     int autograder = 0;  /* If set, emit summary info for autograder (-g) */
+    int run_region = 0;  /* If set, compare against mm_region (set by -R) */
+    int use_thp = 0;     /* If set, back the heap with huge pages (-H) */
+    int fit_k = 0;       /* If set, compare first-fit with best-of-fit_k (-F) */
+    char *json_file = NULL;    /* write results as JSON here (-J) */
+    char *csv_file = NULL;     /* write results as CSV here (-C) */
+    char *compare_file = NULL; /* baseline JSON to compare against (-c) */
+    int regressions = 0;       /* traces that regressed against it */
+    int jobs = 1;              /* worker processes for validation (-j) */
+
+    /* TLB-relevant metrics for the mm package */
+    long faults;               /* minor page faults over the mm evaluation */
+    long long dtlb_misses = 0; /* dTLB load misses while timing mm */
 
     /* temporaries used to compute the performance index */
     double secs, ops, util, avg_mm_util, avg_mm_throughput, p1, p2, perfindex;
@@ -158,7 +268,7 @@ int main(int argc, char **argv)
     /* 
      * Read and interpret the command line arguments 
      */
-    while ((c = getopt(argc, argv, "f:t:hvVgal")) != EOF) {
+    while ((c = getopt(argc, argv, "f:t:hvVgalbRHPSJ:C:c:n:j:D:F:")) != EOF) {
         switch (c) {
 	case 'g': /* Generate summary info for the autograder */
 	    autograder = 1;
@@ -184,6 +294,51 @@ int main(int argc, char **argv)
         case 'l': /* Run libc malloc */
             run_libc = 1;
             break;
+        case 'b': /* Replay runs of requests with the batch API */
+            batch_mode = 1;
+            break;
+        case 'R': /* Compare mm_malloc with mm_region on region traces */
+            run_region = 1;
+            break;
+        case 'H': /* Back the simulated heap with transparent huge pages */
+            use_thp = 1;
+            break;
+        case 'P': /* Report hardware performance counters per op */
+            perf_mode = 1;
+            break;
+        case 'S': /* Print mm event counters */
+            counters_mode = 1;
+            break;
+        case 'J': /* Write per-trace results as JSON */
+            json_file = optarg;
+            break;
+        case 'C': /* Write per-trace results as CSV */
+            csv_file = optarg;
+            break;
+        case 'c': /* Compare against a baseline written by -J */
+            compare_file = optarg;
+            break;
+        case 'F': /* Compare first-fit with bounded best-of-K fit */
+            if ((fit_k = atoi(optarg)) < 1) {
+		usage();
+		exit(1);
+	    }
+            break;
+        case 'D': /* Dump heap snapshots at these op indices */
+            parse_dump_ops(optarg);
+            break;
+        case 'j': /* Validate traces in parallel worker processes */
+            if ((jobs = atoi(optarg)) < 1) {
+		usage();
+		exit(1);
+	    }
+            break;
+        case 'n': /* Number of timed runs per trace */
+            if ((num_runs = atoi(optarg)) < 1) {
+		usage();
+		exit(1);
+	    }
+            break;
         case 'v': /* Print per-trace performance breakdown */
             verbose = 1;
             break;
@@ -229,14 +384,28 @@ int main(int argc, char **argv)
      * If no -f command line arg, then use the entire set of tracefiles 
      * defined in default_traces[]
      */
-    if (tracefiles == NULL) {
+    if (tracefiles == NULL && run_region) {
+        tracefiles = region_tracefiles;
+        num_tracefiles = sizeof(region_tracefiles) / sizeof(char *) - 1;
+	printf("Using region tracefiles in %s\n", tracedir);
+    }
+    else if (tracefiles == NULL) {
         tracefiles = default_tracefiles;
         num_tracefiles = sizeof(default_tracefiles) / sizeof(char *) - 1;
 	printf("Using default tracefiles in %s\n", tracedir);
     }
 
-    /* Initialize the timing package */
+    /* 
+     * Confidence intervals need more than one run per trace, both in
+     * the run being checked and in a baseline being recorded
+     */
+    if (num_runs == 0)
+	num_runs = (compare_file || json_file) ? COMPARE_RUNS : 1;
+
+    /* Initialize the timing package and any hardware counters */
     init_fsecs();
+    if (perfctr_init() == 0 && perf_mode)
+	printf("Hardware counters unavailable; -P columns will show \"-\".\n");
 
     /*
      * Optionally run and evaluate the libc malloc package 
@@ -262,6 +431,8 @@ int main(int argc, char **argv)
 		if (verbose > 1)
 		    printf("and performance.\n");
 		libc_stats[i].secs = fsecs(eval_libc_speed, &speed_params);
+		if (perf_mode)
+		    count_speed(eval_libc_speed, &speed_params, &libc_stats[i]);
 	    }
 	    free_trace(trace);
 	}
@@ -285,33 +456,143 @@ int main(int argc, char **argv)
 	unix_error("mm_stats calloc in main failed");
     
     /* Initialize the simulated memory system in memlib.c */
+    mem_use_hugepages(use_thp);
     mem_init(); 
+    faults = minor_faults();
+    memset(&counts, 0, sizeof(counts));
+
+    /* 
+     * With -j, check correctness and utilization of all traces in
+     * worker processes first; only the timing is left for this loop,
+     * which then runs alone on one pinned CPU 
+     */
+    if (jobs > 1) {
+	eval_mm_parallel(tracefiles, num_tracefiles, mm_stats, jobs);
+	pin_timing_cpu();
+    }
 
     /* Evaluate student's mm malloc package using the K-best scheme */
     for (i=0; i < num_tracefiles; i++) {
 	trace = read_trace(tracedir, tracefiles[i]);
 	mm_stats[i].ops = trace->num_ops;
-	if (verbose > 1)
-	    printf("Checking mm_malloc for correctness, ");
-	mm_stats[i].valid = eval_mm_valid(trace, i, &ranges);
-	if (mm_stats[i].valid) {
+	if (jobs == 1) {
 	    if (verbose > 1)
-		printf("efficiency, ");
-	    mm_stats[i].util = eval_mm_util(trace, i, &ranges);
+		printf("Checking mm_malloc for correctness, ");
+	    mm_stats[i].valid = eval_mm_valid(trace, i, &ranges);
+	    if (mm_stats[i].valid) {
+		if (verbose > 1)
+		    printf("efficiency, ");
+		mm_stats_snapshot(&before);
+		mm_stats[i].util = eval_mm_util(trace, i, &ranges);
+		mm_stats_snapshot(&after);
+		mm_stats[i].heap = mem_heapsize();
+		for (j = 0; j < MM_STAT_NUM; j++)
+		    counts.count[j] += after.count[j] - before.count[j];
+		counted_ops += trace->num_ops;
+	    }
+	}
+	if (mm_stats[i].valid) {
 	    speed_params.trace = trace;
 	    speed_params.ranges = ranges;
 	    if (verbose > 1)
 		printf("and performance.\n");
-	    mm_stats[i].secs = fsecs(eval_mm_speed, &speed_params);
+	    perfctr_start();
+	    time_speed(eval_mm_speed, &speed_params, &mm_stats[i]);
+	    perfctr_stop();
+	    if (perfctr_available(PERFCTR_DTLB_MISSES))
+		dtlb_misses += perfctr_read(PERFCTR_DTLB_MISSES);
+	    if (perf_mode)
+		count_speed(eval_mm_speed, &speed_params, &mm_stats[i]);
 	}
 	free_trace(trace);
     }
+    faults = minor_faults() - faults;
 
     /* Display the mm results in a compact table */
     if (verbose) {
 	printf("\nResults for mm malloc:\n");
 	printresults(num_tracefiles, mm_stats);
 	printf("\n");
+
+	/* TLB-relevant metrics; rerun with/without -H to compare */
+	printf("Heap pages: %s, %ld minor faults, ",
+	       use_thp ? "THP (2 MB)" : "base", faults);
+	if (perfctr_available(PERFCTR_DTLB_MISSES))
+	    printf("%lld dTLB load misses while timing\n", dtlb_misses);
+	else
+	    printf("dTLB load misses unavailable\n");
+	printf("\n");
+    }
+    if (counters_mode) {
+	if (counted_ops > 0)
+	    print_counters(&counts, counted_ops);
+	else
+	    printf("No mm event counters: -S counts the utilization replays, "
+		   "which -j runs in worker processes.\n\n");
+    }
+
+    /*
+     * Optionally run the same traces through the mm_region allocator,
+     * which frees nothing until a request's last object dies
+     */
+    if (run_region) {
+	if (verbose > 1)
+	    printf("\nTesting mm_region\n");
+
+	region_stats = (stats_t *)calloc(num_tracefiles, sizeof(stats_t));
+	if (region_stats == NULL)
+	    unix_error("region_stats calloc in main failed");
+
+	for (i=0; i < num_tracefiles; i++) {
+	    trace = read_trace(tracedir, tracefiles[i]);
+	    region_stats[i].ops = trace->num_ops;
+	    if (verbose > 1)
+		printf("Checking mm_region for correctness, ");
+	    region_stats[i].valid = eval_region_valid(trace, i, &ranges);
+	    if (region_stats[i].valid) {
+		if (verbose > 1)
+		    printf("efficiency, ");
+		region_stats[i].util = eval_region_util(trace);
+		speed_params.trace = trace;
+		if (verbose > 1)
+		    printf("and performance.\n");
+		region_stats[i].secs = fsecs(eval_region_speed, &speed_params);
+		if (perf_mode)
+		    count_speed(eval_region_speed, &speed_params, &region_stats[i]);
+	    }
+	    free_trace(trace);
+	}
+
+	if (verbose) {
+	    printf("Results for mm_region:\n");
+	    printresults(num_tracefiles, region_stats);
+	    printf("\n");
+	}
+    }
+
+    /*
+     * Optionally rerun the traces with first-fit and with bounded
+     * best-of-K fit in the segregated lists, and compare the two
+     */
+    if (fit_k) {
+	first_stats = (stats_t *)calloc(num_tracefiles, sizeof(stats_t));
+	bestk_stats = (stats_t *)calloc(num_tracefiles, sizeof(stats_t));
+	if (first_stats == NULL || bestk_stats == NULL)
+	    unix_error("fit stats calloc in main failed");
+
+	i = mm_set_fit_candidates(1);
+	eval_mm_fit(tracefiles, num_tracefiles, first_stats, 1);
+	eval_mm_fit(tracefiles, num_tracefiles, bestk_stats, fit_k);
+	mm_set_fit_candidates(i);
+
+	if (verbose) {
+	    printf("Results for mm malloc, first-fit:\n");
+	    printresults(num_tracefiles, first_stats);
+	    printf("\nResults for mm malloc, best of %d:\n", fit_k);
+	    printresults(num_tracefiles, bestk_stats);
+	}
+	print_fit_compare(tracefiles, num_tracefiles, first_stats, 
+			  bestk_stats, fit_k);
     }
 
     /* 
@@ -362,7 +643,19 @@ int main(int argc, char **argv)
 	printf("perfidx:%.0f\n", perfindex);
     }
 
-    exit(0);
+    /* 
+     * Optionally write machine-readable results and check them
+     * against a baseline; regressions make the exit status nonzero
+     */
+    if (json_file)
+	write_json(json_file, tracefiles, num_tracefiles, mm_stats, perfindex);
+    if (csv_file)
+	write_csv(csv_file, tracefiles, num_tracefiles, mm_stats);
+    if (compare_file)
+	regressions = compare_results(compare_file, tracefiles, 
+				      num_tracefiles, mm_stats);
+
+    exit(regressions > 0);
 }
 
 
@@ -487,6 +780,8 @@ static trace_t *read_trace(char *tracedir, char *filename)
     /* Allocate the trace record */
     if ((trace = (trace_t *) malloc(sizeof(trace_t))) == NULL)
 	unix_error("malloc 1 failed in read_trance");
+    if ((trace->name = strdup(filename)) == NULL)
+	unix_error("strdup failed in read_trace");
 	
     /* Read the trace file header */
     strcpy(path, tracedir);
@@ -550,6 +845,21 @@ static trace_t *read_trace(char *tracedir, char *filename)
     fclose(tracefile);
     assert(max_index == trace->num_ids - 1);
     assert(trace->num_ops == op_index);
+
+    /* 
+     * Record how many requests starting at each op could be replayed by
+     * one batch call: consecutive frees, or consecutive same-size allocs.
+     */
+    for (op_index = trace->num_ops; op_index-- > 0; ) {
+	traceop_t *op = &trace->ops[op_index];
+	traceop_t *next = op + 1;
+
+	op->batch = 1;
+	if (op_index + 1 < trace->num_ops && op->type != REALLOC &&
+	    next->type == op->type && next->batch < MAXBATCH &&
+	    (op->type == FREE || next->size == op->size))
+	    op->batch = next->batch + 1;
+    }
     
     return trace;
 }
@@ -563,6 +873,7 @@ void free_trace(trace_t *trace)
     free(trace->ops);         /* free the three arrays... */
     free(trace->blocks);      
     free(trace->block_sizes);
+    free(trace->name);
     free(trace);              /* and the trace record itself... */
 }
 
@@ -580,6 +891,7 @@ static int eval_mm_valid(trace_t *trace, int tracenum, range_t **ranges)
     int index;
     int size;
     int oldsize;
+    int nbatch;
     char *newp;
     char *oldp;
     char *p;
@@ -599,6 +911,32 @@ static int eval_mm_valid(trace_t *trace, int tracenum, range_t **ranges)
 	index = trace->ops[i].index;
 	size = trace->ops[i].size;
 
+	/* In -b mode, replay a whole run with one batch call */
+	if (batch_mode && trace->ops[i].batch > 1) {
+	    nbatch = trace->ops[i].batch;
+	    if (trace->ops[i].type == FREE)
+		for (j = 0; j < nbatch; j++)
+		    remove_range(ranges, trace->blocks[trace->ops[i+j].index]);
+
+	    if (mm_batch_op(trace, i) == 0) {
+		malloc_error(tracenum, i, "mm_malloc_batch failed.");
+		return 0;
+	    }
+
+	    if (trace->ops[i].type == ALLOC) {
+		for (j = 0; j < nbatch; j++) {
+		    index = trace->ops[i+j].index;
+		    p = trace->blocks[index];
+		    if (add_range(ranges, p, size, tracenum, i+j) == 0)
+			return 0;
+		    memset(p, index & 0xFF, size);
+		    trace->block_sizes[index] = size;
+		}
+	    }
+	    i += nbatch - 1;
+	    continue;
+	}
+
         switch (trace->ops[i].type) {
 
         case ALLOC: /* mm_malloc */
@@ -653,7 +991,7 @@ static int eval_mm_valid(trace_t *trace, int tracenum, range_t **ranges)
 	    oldsize = trace->block_sizes[index];
 	    if (size < oldsize) oldsize = size;
 	    for (j = 0; j < oldsize; j++) {
-	      if (newp[j] != (index & 0xFF)) {
+	      if ((unsigned char)newp[j] != (index & 0xFF)) {
 		malloc_error(tracenum, i, "mm_realloc did not preserve the "
 			     "data from old block");
 		return 0;
@@ -697,20 +1035,44 @@ static int eval_mm_valid(trace_t *trace, int tracenum, range_t **ranges)
  */
 static double eval_mm_util(trace_t *trace, int tracenum, range_t **ranges)
 {   
-    int i;
+    int i, j;
     int index;
     int size, newsize, oldsize;
     int max_total_size = 0;
     int total_size = 0;
     char *p;
     char *newp, *oldp;
+    FILE *dump_fp = NULL;
+    int next_dump = 0;
 
     /* initialize the heap and the mm malloc package */
     mem_reset_brk();
     if (mm_init() < 0)
 	app_error("mm_init failed in eval_mm_util");
+    if (num_dump_ops > 0)
+	dump_fp = open_dump(trace->name);
 
     for (i = 0;  i < trace->num_ops;  i++) {
+	if (dump_fp)
+	    dump_heap_at(dump_fp, i, &next_dump);
+	if (batch_mode && trace->ops[i].batch > 1) {
+	    for (j = i; j < i + trace->ops[i].batch; j++) {
+		index = trace->ops[j].index;
+		if (trace->ops[j].type == ALLOC) {
+		    trace->block_sizes[index] = trace->ops[j].size;
+		    total_size += trace->ops[j].size;
+		}
+		else
+		    total_size -= trace->block_sizes[index];
+	    }
+	    if (mm_batch_op(trace, i) == 0)
+		app_error("mm_malloc_batch failed in eval_mm_util");
+	    max_total_size = (total_size > max_total_size) ?
+		total_size : max_total_size;
+	    i += trace->ops[i].batch - 1;
+	    continue;
+	}
+
         switch (trace->ops[i].type) {
 
         case ALLOC: /* mm_alloc */
@@ -773,6 +1135,10 @@ static double eval_mm_util(trace_t *trace, int tracenum, range_t **ranges)
 
         }
     }
+    if (dump_fp) {
+	dump_heap_at(dump_fp, trace->num_ops, &next_dump);
+	fclose(dump_fp);
+    }
 
     return ((double)max_total_size / (double)mem_heapsize());
 }
@@ -794,7 +1160,14 @@ static void eval_mm_speed(void *ptr)
 	app_error("mm_init failed in eval_mm_speed");
 
     /* Interpret each trace request */
-    for (i = 0;  i < trace->num_ops;  i++)
+    for (i = 0;  i < trace->num_ops;  i++) {
+	if (batch_mode && trace->ops[i].batch > 1) {
+	    if (mm_batch_op(trace, i) == 0)
+		app_error("mm_malloc_batch error in eval_mm_speed");
+	    i += trace->ops[i].batch - 1;
+	    continue;
+	}
+
         switch (trace->ops[i].type) {
 
         case ALLOC: /* mm_malloc */
@@ -823,6 +1196,33 @@ static void eval_mm_speed(void *ptr)
 	default:
 	    app_error("Nonexistent request type in eval_mm_valid");
         }
+    }
+}
+
+/*
+ * mm_batch_op - Replay the run of trace->ops[i].batch requests starting
+ *    at op i with a single mm_malloc_batch or mm_free_batch call, and
+ *    record the new blocks in trace->blocks. Returns the number of
+ *    requests replayed, or 0 if mm_malloc_batch came up short.
+ */
+static int mm_batch_op(trace_t *trace, int i)
+{
+    void *ptrs[MAXBATCH];
+    int k;
+    int n = trace->ops[i].batch;
+
+    if (trace->ops[i].type == ALLOC) {
+	if (mm_malloc_batch(trace->ops[i].size, n, ptrs) != n)
+	    return 0;
+	for (k = 0; k < n; k++)
+	    trace->blocks[trace->ops[i+k].index] = ptrs[k];
+    }
+    else {
+	for (k = 0; k < n; k++)
+	    ptrs[k] = trace->blocks[trace->ops[i+k].index];
+	mm_free_batch(ptrs, n);
+    }
+    return n;
 }
 
 /*
@@ -910,6 +1310,217 @@ static void eval_libc_speed(void *ptr)
     }
 }
 
+/**********************************************************************
+ * The following functions replay a trace against the mm_region
+ * bump-pointer allocator. Frees only drop a live count; when the last
+ * live block of a request dies, the whole region is reset at once.
+ * Reallocs bump a new block and copy, since regions cannot grow in place.
+ **********************************************************************/
+
+/*
+ * region_realloc - Bump a new size-byte block and copy the old data
+ */
+static void *region_realloc(mm_region_t *region, char *oldp, 
+			    size_t oldsize, size_t size)
+{
+    char *newp;
+
+    if ((newp = mm_region_alloc(region, size)) == NULL)
+	return NULL;
+    memcpy(newp, oldp, (size < oldsize) ? size : oldsize);
+    return newp;
+}
+
+/*
+ * eval_region_valid - Check the mm_region allocator for correctness
+ */
+static int eval_region_valid(trace_t *trace, int tracenum, range_t **ranges)
+{
+    int i;
+    int index, size;
+    int live = 0;
+    char *p, *oldp;
+    mm_region_t *region;
+
+    /* Reset the heap and free any records in the range list */
+    mem_reset_brk();
+    clear_ranges(ranges);
+
+    /* The region takes its chunks from the mm package */
+    if (mm_init() < 0) {
+	malloc_error(tracenum, 0, "mm_init failed.");
+	return 0;
+    }
+    if ((region = mm_region_create(0)) == NULL) {
+	malloc_error(tracenum, 0, "mm_region_create failed.");
+	return 0;
+    }
+
+    for (i = 0;  i < trace->num_ops;  i++) {
+	index = trace->ops[i].index;
+	size = trace->ops[i].size;
+
+        switch (trace->ops[i].type) {
+
+        case ALLOC: /* mm_region_alloc */
+	    if ((p = mm_region_alloc(region, size)) == NULL) {
+		malloc_error(tracenum, i, "mm_region_alloc failed.");
+		return 0;
+	    }
+	    if (add_range(ranges, p, size, tracenum, i) == 0)
+		return 0;
+	    memset(p, index & 0xFF, size);
+	    trace->blocks[index] = p;
+	    trace->block_sizes[index] = size;
+	    live++;
+	    break;
+
+        case REALLOC: /* mm_region_alloc + copy */
+	    oldp = trace->blocks[index];
+	    p = region_realloc(region, oldp, trace->block_sizes[index], size);
+	    if (p == NULL) {
+		malloc_error(tracenum, i, "mm_region_alloc failed.");
+		return 0;
+	    }
+	    remove_range(ranges, oldp);
+	    if (add_range(ranges, p, size, tracenum, i) == 0)
+		return 0;
+	    memset(p, index & 0xFF, size);
+	    trace->blocks[index] = p;
+	    trace->block_sizes[index] = size;
+	    break;
+
+        case FREE: /* drop the block; reset once the request is done */
+	    remove_range(ranges, trace->blocks[index]);
+	    if (--live == 0)
+		mm_region_reset(region);
+	    break;
+
+	default:
+	    app_error("Nonexistent request type in eval_region_valid");
+        }
+    }
+
+    mm_region_destroy(region);
+    return 1;
+}
+
+/*
+ * eval_region_util - Evaluate the space utilization of mm_region,
+ *    using the same high water mark ratio as eval_mm_util
+ */
+static double eval_region_util(trace_t *trace)
+{
+    int i;
+    int index, size;
+    int live = 0;
+    int max_total_size = 0;
+    int total_size = 0;
+    char *p;
+    mm_region_t *region;
+
+    mem_reset_brk();
+    if (mm_init() < 0)
+	app_error("mm_init failed in eval_region_util");
+    if ((region = mm_region_create(0)) == NULL)
+	app_error("mm_region_create failed in eval_region_util");
+
+    for (i = 0;  i < trace->num_ops;  i++) {
+	index = trace->ops[i].index;
+	size = trace->ops[i].size;
+
+        switch (trace->ops[i].type) {
+
+        case ALLOC:
+	    if ((p = mm_region_alloc(region, size)) == NULL)
+		app_error("mm_region_alloc failed in eval_region_util");
+	    trace->blocks[index] = p;
+	    trace->block_sizes[index] = size;
+	    total_size += size;
+	    live++;
+	    break;
+
+        case REALLOC:
+	    p = region_realloc(region, trace->blocks[index], 
+			       trace->block_sizes[index], size);
+	    if (p == NULL)
+		app_error("mm_region_alloc failed in eval_region_util");
+	    total_size += size - trace->block_sizes[index];
+	    trace->blocks[index] = p;
+	    trace->block_sizes[index] = size;
+	    break;
+
+        case FREE:
+	    total_size -= trace->block_sizes[index];
+	    if (--live == 0)
+		mm_region_reset(region);
+	    break;
+
+	default:
+	    app_error("Nonexistent request type in eval_region_util");
+        }
+	max_total_size = (total_size > max_total_size) ?
+	    total_size : max_total_size;
+    }
+
+    mm_region_destroy(region);
+    return ((double)max_total_size / (double)mem_heapsize());
+}
+
+/*
+ * eval_region_speed - This is the function that is used by fcyc()
+ *    to measure the running time of the mm_region allocator.
+ */
+static void eval_region_speed(void *ptr)
+{
+    int i, index, size;
+    int live = 0;
+    char *p;
+    mm_region_t *region;
+    trace_t *trace = ((speed_t *)ptr)->trace;
+
+    mem_reset_brk();
+    if (mm_init() < 0) 
+	app_error("mm_init failed in eval_region_speed");
+    if ((region = mm_region_create(0)) == NULL)
+	app_error("mm_region_create failed in eval_region_speed");
+
+    for (i = 0;  i < trace->num_ops;  i++) {
+	index = trace->ops[i].index;
+	size = trace->ops[i].size;
+
+        switch (trace->ops[i].type) {
+
+        case ALLOC:
+	    if ((p = mm_region_alloc(region, size)) == NULL)
+		app_error("mm_region_alloc error in eval_region_speed");
+	    trace->blocks[index] = p;
+	    trace->block_sizes[index] = size;
+	    live++;
+	    break;
+
+        case REALLOC:
+	    p = region_realloc(region, trace->blocks[index], 
+			       trace->block_sizes[index], size);
+	    if (p == NULL)
+		app_error("mm_region_alloc error in eval_region_speed");
+	    trace->blocks[index] = p;
+	    trace->block_sizes[index] = size;
+	    break;
+
+        case FREE:
+	    if (--live == 0)
+		mm_region_reset(region);
+	    break;
+
+	default:
+	    app_error("Nonexistent request type in eval_region_speed");
+        }
+    }
+
+    mm_region_destroy(region);
+}
+
 /*************************************
  * Some miscellaneous helper routines
  ************************************/
@@ -920,17 +1531,26 @@ static void eval_libc_speed(void *ptr)
  */
 static void printresults(int n, stats_t *stats) 
 {
-    int i;
+    int i, j;
     double secs = 0;
     double ops = 0;
     double util = 0;
+    double ctrs[PERFCTR_NUM] = {0}; /* summed counts, -1 once unavailable */
+    char name[MAXLINE];
 
     /* Print the individual results for each trace */
-    printf("%5s%7s %5s%8s%10s%6s\n", 
+    printf("%5s%7s %5s%8s%10s%6s", 
 	   "trace", " valid", "util", "ops", "secs", "Kops");
+    if (perf_mode) {
+	for (j = 0; j < PERFCTR_NUM; j++) {
+	    sprintf(name, "%s/op", perfctr_name(j));
+	    printf("%10s", name);
+	}
+    }
+    printf("\n");
     for (i=0; i < n; i++) {
 	if (stats[i].valid) {
-	    printf("%2d%10s%5.0f%%%8.0f%10.6f%6.0f\n", 
+	    printf("%2d%10s%5.0f%%%8.0f%10.6f%6.0f", 
 		   i,
 		   "yes",
 		   stats[i].util*100.0,
@@ -940,36 +1560,601 @@ static void printresults(int n, stats_t *stats)
 	    secs += stats[i].secs;
 	    ops += stats[i].ops;
 	    util += stats[i].util;
+	    for (j = 0; perf_mode && j < PERFCTR_NUM; j++) {
+		if (stats[i].ctrs[j] < 0 || ctrs[j] < 0)
+		    ctrs[j] = -1;
+		else
+		    ctrs[j] += stats[i].ctrs[j];
+		if (stats[i].ctrs[j] < 0)
+		    printf("%10s", "-");
+		else
+		    printf("%10.1f", stats[i].ctrs[j]/stats[i].ops);
+	    }
+	    printf("\n");
 	}
 	else {
-	    printf("%2d%10s%6s%8s%10s%6s\n", 
+	    printf("%2d%10s%6s%8s%10s%6s", 
 		   i,
 		   "no",
 		   "-",
 		   "-",
 		   "-",
 		   "-");
+	    for (j = 0; perf_mode && j < PERFCTR_NUM; j++)
+		printf("%10s", "-");
+	    printf("\n");
 	}
     }
 
     /* Print the aggregate results for the set of traces */
     if (errors == 0) {
-	printf("%12s%5.0f%%%8.0f%10.6f%6.0f\n", 
+	printf("%12s%5.0f%%%8.0f%10.6f%6.0f", 
 	       "Total       ",
 	       (util/n)*100.0,
 	       ops, 
 	       secs,
 	       (ops/1e3)/secs);
+	for (j = 0; perf_mode && j < PERFCTR_NUM; j++) {
+	    if (ctrs[j] < 0)
+		printf("%10s", "-");
+	    else
+		printf("%10.1f", ctrs[j]/ops);
+	}
+	printf("\n");
     }
     else {
-	printf("%12s%6s%8s%10s%6s\n", 
+	printf("%12s%6s%8s%10s%6s", 
 	       "Total       ",
 	       "-", 
 	       "-", 
 	       "-", 
 	       "-");
+	for (j = 0; perf_mode && j < PERFCTR_NUM; j++)
+	    printf("%10s", "-");
+	printf("\n");
+    }
+
+}
+
+/*
+ * count_speed - Replay a trace once more, untimed, with the hardware
+ *    counters running (-P), and keep the raw counts in stats->ctrs.
+ *    A single replay gives exact per-op counts without perturbing
+ *    the timed runs.
+ */
+static void count_speed(fsecs_test_funct f, void *argp, stats_t *stats)
+{
+    int j;
+
+    perfctr_start();
+    f(argp);
+    perfctr_stop();
+    for (j = 0; j < PERFCTR_NUM; j++)
+	stats->ctrs[j] = perfctr_read(j);
+}
+
+/*
+ * time_speed - Time a trace num_runs times with fsecs. stats->secs is
+ *    the mean time per run; stats->kops and stats->kops_sd are the mean
+ *    and sample standard deviation of the per-run throughput.
+ */
+static void time_speed(fsecs_test_funct f, void *argp, stats_t *stats)
+{
+    int i;
+    double secs, kops, sum = 0, sum_kops = 0, sum_sq = 0;
+
+    for (i = 0; i < num_runs; i++) {
+	secs = fsecs(f, argp);
+	kops = (stats->ops/1e3)/secs;
+	sum += secs;
+	sum_kops += kops;
+	sum_sq += kops*kops;
     }
+    stats->runs = num_runs;
+    stats->secs = sum/num_runs;
+    stats->kops = sum_kops/num_runs;
+    stats->kops_sd = 0;
+    if (num_runs > 1 && sum_sq > sum_kops*stats->kops)
+	stats->kops_sd = sqrt((sum_sq - sum_kops*stats->kops)/(num_runs - 1));
+}
+
+/*
+ * write_json - Write the per-trace mm results to file as JSON. Each
+ *    trace object sits on a line of its own, which is the layout
+ *    read_baseline expects back.
+ */
+static void write_json(char *file, char **tracefiles, int n, 
+		       stats_t *stats, double perfindex)
+{
+    int i;
+    FILE *fp;
+
+    if ((fp = fopen(file, "w")) == NULL) {
+	sprintf(msg, "Could not open %s in write_json", file);
+	unix_error(msg);
+    }
+    fprintf(fp, "{\n  \"perfidx\": %.0f,\n  \"runs\": %d,\n  \"traces\": [\n",
+	    perfindex, num_runs);
+    for (i = 0; i < n; i++) {
+	fprintf(fp, "    {\"trace\": \"%s\", \"valid\": %d, \"util\": %.6f, "
+		"\"ops\": %.0f, \"secs\": %.9f, \"kops\": %.3f, "
+		"\"kops_sd\": %.3f, \"runs\": %d, \"heap\": %.0f}%s\n",
+		tracefiles[i], stats[i].valid, stats[i].util, 
+		stats[i].ops, stats[i].secs, stats[i].kops, 
+		stats[i].kops_sd, stats[i].runs, stats[i].heap,
+		(i < n-1) ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    fclose(fp);
+}
 
+/*
+ * write_csv - Write the per-trace mm results to file as CSV
+ */
+static void write_csv(char *file, char **tracefiles, int n, stats_t *stats)
+{
+    int i;
+    FILE *fp;
+
+    if ((fp = fopen(file, "w")) == NULL) {
+	sprintf(msg, "Could not open %s in write_csv", file);
+	unix_error(msg);
+    }
+    fprintf(fp, "trace,valid,util,ops,secs,kops,kops_sd,runs,heap\n");
+    for (i = 0; i < n; i++) {
+	fprintf(fp, "%s,%d,%.6f,%.0f,%.9f,%.3f,%.3f,%d,%.0f\n",
+		tracefiles[i], stats[i].valid, stats[i].util, 
+		stats[i].ops, stats[i].secs, stats[i].kops, 
+		stats[i].kops_sd, stats[i].runs, stats[i].heap);
+    }
+    fclose(fp);
+}
+
+/*
+ * json_field - Return a pointer to the value of "key" in the JSON text
+ *    obj, or NULL if obj has no such key
+ */
+static char *json_field(char *obj, char *key)
+{
+    char pat[MAXLINE];
+    char *p;
+
+    sprintf(pat, "\"%s\":", key);
+    if ((p = strstr(obj, pat)) == NULL)
+	return NULL;
+    return p + strlen(pat);
+}
+
+/*
+ * read_baseline - Read back the trace objects of a file written by -J.
+ *    Fields are found by key, in any order and spacing, but each trace
+ *    object must sit on a line of its own as -J writes it. trace,
+ *    valid, util and kops are required; a missing kops_sd or runs
+ *    reads as a single run. Returns a malloc'd array and sets *n to
+ *    its length.
+ */
+static baseline_t *read_baseline(char *file, int *n)
+{
+    FILE *fp;
+    char line[2*MAXLINE];
+    char *p;
+    baseline_t *base = NULL;
+    baseline_t b;
+    int max = 0;
+
+    if ((fp = fopen(file, "r")) == NULL) {
+	sprintf(msg, "Could not open %s in read_baseline", file);
+	unix_error(msg);
+    }
+    *n = 0;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+	if ((p = json_field(line, "trace")) == NULL)
+	    continue;
+	if (sscanf(p, " \"%1023[^\"]\"", b.trace) != 1 ||
+	    (p = json_field(line, "valid")) == NULL || 
+	    sscanf(p, "%d", &b.valid) != 1 ||
+	    (p = json_field(line, "util")) == NULL || 
+	    sscanf(p, "%lf", &b.util) != 1 ||
+	    (p = json_field(line, "kops")) == NULL || 
+	    sscanf(p, "%lf", &b.kops) != 1) {
+	    sprintf(msg, "Malformed trace entry in baseline %s", file);
+	    app_error(msg);
+	}
+	b.kops_sd = 0;
+	b.runs = 1;
+	if ((p = json_field(line, "kops_sd")) != NULL)
+	    sscanf(p, "%lf", &b.kops_sd);
+	if ((p = json_field(line, "runs")) != NULL)
+	    sscanf(p, "%d", &b.runs);
+	if (*n == max) {
+	    max = max ? 2*max : 16;
+	    if ((base = realloc(base, max*sizeof(baseline_t))) == NULL)
+		unix_error("realloc failed in read_baseline");
+	}
+	base[(*n)++] = b;
+    }
+    fclose(fp);
+    return base;
+}
+
+/*
+ * compare_results - Compare the mm results against a baseline written
+ *    by -J and print one verdict per trace. A throughput change counts
+ *    only when the 95% confidence interval of the difference of means
+ *    (Welch's t) excludes zero. Utilization is deterministic for a
+ *    given allocator, so any drop beyond UTIL_TOLERANCE counts. A
+ *    trace that was already invalid in the baseline is reported but
+ *    not counted. Returns the number of regressed traces.
+ */
+static int compare_results(char *file, char **tracefiles, int n, 
+			   stats_t *stats)
+{
+    int i, j, nbase, regressions = 0, single = 0;
+    baseline_t *base, *b;
+    double vb, vc, se, df, diff, ci;
+    char *verdict;
+
+    base = read_baseline(file, &nbase);
+    for (j = 0; j < nbase; j++)
+	if (base[j].runs < 2)
+	    single++;
+    if (single > 0)
+	printf("Warning: %d baseline trace%s timed only once; throughput "
+	       "verdicts for %s ignore\nthe baseline's run-to-run noise "
+	       "(record it with -n 2 or more).\n", single, 
+	       single == 1 ? " was" : "s were", single == 1 ? "it" : "them");
+
+    printf("\nComparison against %s (95%% confidence, %d runs):\n", 
+	   file, num_runs);
+    printf("%-20s%7s%7s%10s%10s%9s%9s  %s\n", "trace", "b.util", "util", 
+	   "b.Kops", "Kops", "change", "+/-", "verdict");
+    for (i = 0; i < n; i++) {
+	b = NULL;
+	for (j = 0; j < nbase; j++)
+	    if (!strcmp(base[j].trace, tracefiles[i]))
+		b = &base[j];
+	if (b == NULL || !b->valid || !stats[i].valid) {
+	    if (b == NULL)
+		verdict = "new";
+	    else if (!b->valid && !stats[i].valid)
+		verdict = "still invalid";
+	    else if (!stats[i].valid) {
+		verdict = "REGRESSED (invalid)";
+		regressions++;
+	    }
+	    else
+		verdict = "fixed";
+	    printf("%-20s%7s%7s%10s%10s%9s%9s  %s\n", tracefiles[i], 
+		   "-", "-", "-", "-", "-", "-", verdict);
+	    continue;
+	}
+
+	/* Welch's t interval for kops - b.kops */
+	vb = b->runs > 1 ? b->kops_sd*b->kops_sd/b->runs : 0;
+	vc = stats[i].runs > 1 ? stats[i].kops_sd*stats[i].kops_sd/stats[i].runs : 0;
+	se = sqrt(vb + vc);
+	df = 1;
+	if (vb > 0 || vc > 0) {
+	    df = (vb + vc)*(vb + vc);
+	    df /= (b->runs > 1 ? vb*vb/(b->runs - 1) : 0) + 
+		(stats[i].runs > 1 ? vc*vc/(stats[i].runs - 1) : 0);
+	}
+	diff = stats[i].kops - b->kops;
+	ci = t_crit95(df)*se;
+
+	if (stats[i].util < b->util - UTIL_TOLERANCE) {
+	    verdict = "REGRESSED (util)";
+	    regressions++;
+	}
+	else if (diff + ci < 0) {
+	    verdict = "REGRESSED (throughput)";
+	    regressions++;
+	}
+	else if (diff - ci > 0)
+	    verdict = "faster";
+	else
+	    verdict = "ok";
+	printf("%-20s%6.1f%%%6.1f%%%10.0f%10.0f%8.1f%%%8.1f%%  %s\n", 
+	       tracefiles[i], b->util*100.0, stats[i].util*100.0, 
+	       b->kops, stats[i].kops, diff/b->kops*100.0, 
+	       ci/b->kops*100.0, verdict);
+    }
+    printf("%d regression%s\n", regressions, regressions == 1 ? "" : "s");
+    free(base);
+    return regressions;
+}
+
+/*
+ * t_crit95 - Two-sided 95% critical value of Student's t for df degrees
+ *    of freedom (normal approximation beyond 30)
+ */
+static double t_crit95(double df)
+{
+    static double t[] = {
+	12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+	2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+	2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    int d = (int)df;
+
+    if (d < 1)
+	d = 1;
+    return (d <= 30) ? t[d-1] : 1.960;
+}
+
+/*
+ * eval_mm_parallel - Check the correctness and utilization of every
+ *    trace, running up to jobs worker processes at a time. Each worker
+ *    is forked from the initialized driver, so it gets a private
+ *    copy-on-write image of the memlib heap and replays one trace on
+ *    it. Results come back through a pipe; a worker that dies without
+ *    reporting marks its trace invalid.
+ */
+static void eval_mm_parallel(char **tracefiles, int n, stats_t *stats, 
+			     int jobs)
+{
+    int i, status, next = 0, running = 0;
+    int fd[2];
+    pid_t pid, *pids;
+    workres_t res;
+
+    if ((pids = calloc(n, sizeof(pid_t))) == NULL)
+	unix_error("calloc failed in eval_mm_parallel");
+    if (pipe(fd) < 0)
+	unix_error("pipe failed in eval_mm_parallel");
+
+    while (next < n || running > 0) {
+	if (next < n && running < jobs) {
+	    fflush(stdout); /* don't let the worker repeat buffered output */
+	    if ((pid = fork()) < 0)
+		unix_error("fork failed in eval_mm_parallel");
+	    if (pid == 0) {
+		close(fd[0]);
+		eval_mm_worker(tracefiles[next], next, fd[1]);
+	    }
+	    pids[next++] = pid;
+	    running++;
+	    continue;
+	}
+
+	/*
+	 * Reap a worker; if it died without reporting, say so. A clean
+	 * exit means its record is already in the pipe, so read it now:
+	 * left there, the records of a long trace list would fill the
+	 * pipe and block the next workers in write
+	 */
+	if ((pid = wait(&status)) < 0)
+	    unix_error("wait failed in eval_mm_parallel");
+	running--;
+	if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+	    if (read(fd[0], &res, sizeof(res)) != sizeof(res))
+		unix_error("read failed in eval_mm_parallel");
+	    parallel_result(stats, &res);
+	    continue;
+	}
+	for (i = 0; i < n; i++) {
+	    if (pids[i] == pid) {
+		errors++;
+		printf("ERROR [trace %d]: worker died (status %d)\n", i, status);
+	    }
+	}
+    }
+    close(fd[1]);
+
+    /* A worker that wrote its record and then died left one more */
+    while (read(fd[0], &res, sizeof(res)) == sizeof(res))
+	parallel_result(stats, &res);
+    close(fd[0]);
+    free(pids);
+}
+
+/*
+ * parallel_result - Record one worker's results for its trace
+ */
+static void parallel_result(stats_t *stats, workres_t *res)
+{
+    stats[res->tracenum].valid = res->valid;
+    stats[res->tracenum].util = res->util;
+    stats[res->tracenum].heap = res->heap;
+    errors += res->errors;
+}
+
+/*
+ * eval_mm_worker - Body of a -j worker process: validate one trace,
+ *    measure its utilization and write a workres_t record to fd. The
+ *    record is smaller than PIPE_BUF, so concurrent writes never
+ *    interleave. Never returns.
+ */
+static void eval_mm_worker(char *tracefile, int tracenum, int fd)
+{
+    trace_t *trace;
+    range_t *ranges = NULL;
+    workres_t res;
+
+    memset(&res, 0, sizeof(res));
+    res.tracenum = tracenum;
+    trace = read_trace(tracedir, tracefile);
+    res.valid = eval_mm_valid(trace, tracenum, &ranges);
+    if (res.valid) {
+	res.util = eval_mm_util(trace, tracenum, &ranges);
+	res.heap = mem_heapsize();
+    }
+    res.errors = errors;
+    if (write(fd, &res, sizeof(res)) != sizeof(res))
+	unix_error("write failed in eval_mm_worker");
+    fflush(stdout);
+    _exit(0);
+}
+
+/*
+ * pin_timing_cpu - Bind the driver to a single CPU for the timing
+ *    phase, so runs never migrate between cores mid-measurement. We
+ *    take the highest-numbered CPU we may run on: housekeeping work
+ *    and interrupts tend to land on the low ones, and CPUs set aside
+ *    with isolcpus can be handed to us with taskset.
+ */
+static void pin_timing_cpu(void)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    int cpu;
+
+    if (sched_getaffinity(0, sizeof(set), &set) < 0)
+	return;
+    for (cpu = CPU_SETSIZE - 1; cpu >= 0; cpu--)
+	if (CPU_ISSET(cpu, &set))
+	    break;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) < 0)
+	return;
+    if (verbose > 1)
+	printf("Timing on CPU %d\n", cpu);
+#endif
+}
+
+/*
+ * eval_mm_fit - Check, measure and time every trace with the mm package
+ *    choosing among k candidates in its segregated lists
+ */
+static void eval_mm_fit(char **tracefiles, int n, stats_t *stats, int k)
+{
+    int i;
+    trace_t *trace;
+    range_t *ranges = NULL;
+    speed_t speed_params;
+
+    mm_set_fit_candidates(k);
+    for (i = 0; i < n; i++) {
+	trace = read_trace(tracedir, tracefiles[i]);
+	stats[i].ops = trace->num_ops;
+	stats[i].valid = eval_mm_valid(trace, i, &ranges);
+	if (stats[i].valid) {
+	    stats[i].util = eval_mm_util(trace, i, &ranges);
+	    stats[i].heap = mem_heapsize();
+	    speed_params.trace = trace;
+	    speed_params.ranges = ranges;
+	    time_speed(eval_mm_speed, &speed_params, &stats[i]);
+	    if (perf_mode)
+		count_speed(eval_mm_speed, &speed_params, &stats[i]);
+	}
+	free_trace(trace);
+    }
+    clear_ranges(&ranges);
+}
+
+/*
+ * print_fit_compare - Per-trace utilization and mean latency per op
+ *    for first-fit against best-of-k
+ */
+static void print_fit_compare(char **tracefiles, int n, stats_t *first, 
+			      stats_t *bestk, int k)
+{
+    int i;
+    double f_ns, k_ns, f_ops = 0, f_secs = 0, k_secs = 0;
+    double f_util = 0, k_util = 0;
+    char label[MAXLINE];
+
+    printf("\nFirst-fit vs best of %d in the segregated lists:\n", k);
+    sprintf(label, "best%d", k);
+    printf("%-20s%7s%7s%10s%10s%8s\n", "trace", "first", label, 
+	   "first ns", "ns/op", "change");
+    for (i = 0; i < n; i++) {
+	if (!first[i].valid || !bestk[i].valid) {
+	    printf("%-20s%7s%7s%10s%10s%8s\n", tracefiles[i], 
+		   "-", "-", "-", "-", "-");
+	    continue;
+	}
+	f_ns = first[i].secs/first[i].ops*1e9;
+	k_ns = bestk[i].secs/bestk[i].ops*1e9;
+	printf("%-20s%6.1f%%%6.1f%%%10.1f%10.1f%7.1f%%\n", tracefiles[i], 
+	       first[i].util*100.0, bestk[i].util*100.0, 
+	       f_ns, k_ns, (k_ns/f_ns - 1)*100.0);
+	f_ops += first[i].ops;
+	f_secs += first[i].secs;
+	k_secs += bestk[i].secs;
+	f_util += first[i].util;
+	k_util += bestk[i].util;
+    }
+    if (f_ops > 0)
+	printf("%-20s%6.1f%%%6.1f%%%10.1f%10.1f%7.1f%%\n", "Total", 
+	       f_util/n*100.0, k_util/n*100.0, f_secs/f_ops*1e9, 
+	       k_secs/f_ops*1e9, (k_secs/f_secs - 1)*100.0);
+    printf("\n");
+}
+
+/*
+ * parse_dump_ops - Parse the comma-separated op indices given to -D
+ *    into the sorted dump_ops array
+ */
+static void parse_dump_ops(char *list)
+{
+    char *tok;
+    int op, i;
+
+    for (tok = strtok(list, ","); tok != NULL; tok = strtok(NULL, ",")) {
+	if ((op = atoi(tok)) < 0) {
+	    usage();
+	    exit(1);
+	}
+	if ((dump_ops = realloc(dump_ops, (num_dump_ops+1)*sizeof(int))) == NULL)
+	    unix_error("realloc failed in parse_dump_ops");
+	for (i = num_dump_ops++; i > 0 && dump_ops[i-1] > op; i--)
+	    dump_ops[i] = dump_ops[i-1];
+	dump_ops[i] = op;
+    }
+}
+
+/*
+ * open_dump - Open the -D dump file for a trace: its base name with
+ *    ".heap" in place of the ".rep" suffix, in the current directory
+ */
+static FILE *open_dump(char *tracename)
+{
+    char path[MAXLINE];
+    char *base, *dot;
+    FILE *fp;
+
+    base = strrchr(tracename, '/');
+    strcpy(path, base ? base + 1 : tracename);
+    if ((dot = strrchr(path, '.')) != NULL)
+	*dot = '\0';
+    strcat(path, ".heap");
+    if ((fp = fopen(path, "wb")) == NULL) {
+	sprintf(msg, "Could not open %s in open_dump", path);
+	unix_error(msg);
+    }
+    if (verbose > 1)
+	printf("Dumping heap snapshots to %s\n", path);
+    return fp;
+}
+
+/*
+ * dump_heap_at - Called before op opnum of the utilization replay.
+ *    Writes one snapshot if any requested index not yet dumped is at
+ *    or before opnum; batch replay (-b) can step over an index, and
+ *    then the snapshot lands on the first op after it.
+ */
+static void dump_heap_at(FILE *fp, int opnum, int *next)
+{
+    if (*next >= num_dump_ops || dump_ops[*next] > opnum)
+	return;
+    if (mm_dump_heap(fp, opnum) < 0)
+	unix_error("mm_dump_heap failed");
+    while (*next < num_dump_ops && dump_ops[*next] <= opnum)
+	(*next)++;
+}
+
+/*
+ * minor_faults - minor page faults taken by this process so far
+ */
+static long minor_faults(void)
+{
+    struct rusage ru;
+
+    if (getrusage(RUSAGE_SELF, &ru) < 0)
+	unix_error("getrusage failed");
+    return ru.ru_minflt;
 }
 
 /* 
@@ -1004,14 +2189,51 @@ void malloc_error(int tracenum, int opnum, char *msg)
  */
 static void usage(void) 
 {
-    fprintf(stderr, "Usage: mdriver [-hvVal] [-f <file>] [-t <dir>]\n");
+    fprintf(stderr, "Usage: mdriver [-hvValbRHPS] [-f <file>] [-t <dir>] [-n <runs>]\n"
+	    "               [-D <op,...>] [-F <k>] [-j <jobs>] [-J <file>] [-C <file>] [-c <baseline>]\n");
     fprintf(stderr, "Options\n");
     fprintf(stderr, "\t-a         Don't check the team structure.\n");
+    fprintf(stderr, "\t-b         Replay request runs with the mm batch API.\n");
+    fprintf(stderr, "\t-c <file>  Flag regressions against a baseline written by -J.\n");
+    fprintf(stderr, "\t-C <file>  Write per-trace mm results to <file> as CSV.\n");
+    fprintf(stderr, "\t-D <ops>   Dump heap snapshots before these ops to <trace>.heap.\n");
     fprintf(stderr, "\t-f <file>  Use <file> as the trace file.\n");
+    fprintf(stderr, "\t-F <k>     Compare first-fit with best-of-<k> fit.\n");
     fprintf(stderr, "\t-g         Generate summary info for autograder.\n");
     fprintf(stderr, "\t-h         Print this message.\n");
+    fprintf(stderr, "\t-H         Back the heap with transparent huge pages.\n");
+    fprintf(stderr, "\t-j <jobs>  Validate traces in <jobs> processes, then time on one CPU.\n");
+    fprintf(stderr, "\t-J <file>  Write per-trace mm results to <file> as JSON.\n");
     fprintf(stderr, "\t-l         Run libc malloc as well.\n");
+    fprintf(stderr, "\t-n <runs>  Time each trace <runs> times (default 1, 5 with -c or -J).\n");
+    fprintf(stderr, "\t-P         Report hardware counters per op (with -v).\n");
+    fprintf(stderr, "\t-R         Compare mm malloc with mm_region on region traces.\n");
+    fprintf(stderr, "\t-S         Print mm event counters for the utilization replays.\n");
     fprintf(stderr, "\t-t <dir>   Directory to find default traces.\n");
     fprintf(stderr, "\t-v         Print per-trace performance breakdowns.\n");
     fprintf(stderr, "\t-V         Print additional debug info.\n");
 }
+
+/*
+ * print_counters - Print the mm event counters summed over the
+ *    utilization replays of all traces, with their rate per trace op
+ */
+static void print_counters(mm_stats_t *counts, double ops)
+{
+    int i;
+    double req = counts->count[MM_STAT_BYTES_REQ];
+
+    if (counts->count[MM_STAT_MALLOC] == 0) {
+	printf("No mm event counters: mm.c was built with MM_STATS=0.\n\n");
+	return;
+    }
+    printf("mm event counters over %.0f replayed ops:\n", ops);
+    printf("%-20s%14s%10s\n", "counter", "total", "per op");
+    for (i = 0; i < MM_STAT_NUM; i++)
+	printf("%-20s%14llu%10.3f\n", mm_stats_name(i), 
+	       (unsigned long long)counts->count[i], counts->count[i] / ops);
+    if (req > 0)
+	printf("Granted / requested bytes: %.3f\n", 
+	       counts->count[MM_STAT_BYTES_GRANTED] / req);
+    printf("\n");
+}
@@ -14,24 +14,56 @@
 #include "memlib.h"
 #include "config.h"
 
+/* Transparent huge page size; the heap is always aligned to it */
+#define MEM_HUGEPAGE (1<<21)   /* 2 MB */
+
 /* private variables */
+static char *mem_map_start;  /* start of the mmap'd reservation */
+static size_t mem_map_size;  /* length of the mmap'd reservation */
+static int mem_thp = 0;      /* ask for transparent huge pages? */
 static char *mem_start_brk;  /* points to first byte of heap */
 static char *mem_brk;        /* points to last byte of heap */
 static char *mem_max_addr;   /* largest legal heap address */ 
+static char *mem_fresh_brk;  /* bytes at or above this were never handed out */
+
+/*
+ * mem_use_hugepages - back the heap with transparent huge pages (on != 0)
+ *    or force base pages (on == 0). Must be called before mem_init.
+ */
+void mem_use_hugepages(int on)
+{
+    mem_thp = on;
+}
 
 /* 
  * mem_init - initialize the memory system model
  */
 void mem_init(void)
 {
-    /* allocate the storage we will use to model the available VM */
-    if ((mem_start_brk = (char *)malloc(MAX_HEAP)) == NULL) {
-	fprintf(stderr, "mem_init_vm: malloc error\n");
+    /* 
+     * Reserve the storage we will use to model the available VM with an
+     * anonymous mmap: its pages are zero-filled and lazily faulted, so
+     * memory that mem_sbrk has never handed out is known to be zero.
+     * Over-reserve by one huge page so the heap can start 2 MB aligned.
+     */
+    mem_map_size = MAX_HEAP + MEM_HUGEPAGE;
+    mem_map_start = mmap(NULL, mem_map_size, PROT_READ | PROT_WRITE,
+			 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem_map_start == MAP_FAILED) {
+	fprintf(stderr, "mem_init_vm: mmap error\n");
 	exit(1);
     }
+    mem_start_brk = (char *)(((size_t)mem_map_start + MEM_HUGEPAGE - 1)
+			     & ~(size_t)(MEM_HUGEPAGE - 1));
+
+#if defined(MADV_HUGEPAGE) && defined(MADV_NOHUGEPAGE)
+    /* Say which we want either way, so THP "always" can't blur the A/B */
+    madvise(mem_start_brk, MAX_HEAP, mem_thp ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+#endif
 
     mem_max_addr = mem_start_brk + MAX_HEAP;  /* max legal heap address */
     mem_brk = mem_start_brk;                  /* heap is empty initially */
+    mem_fresh_brk = mem_start_brk;            /* every byte is still zero */
 }
 
 /* 
@@ -39,7 +71,7 @@ void mem_init(void)
  */
 void mem_deinit(void)
 {
-    free(mem_start_brk);
+    munmap(mem_map_start, mem_map_size);
 }
 
 /*
@@ -65,6 +97,8 @@ void *mem_sbrk(int incr)
 	return (void *)-1;
     }
     mem_brk += incr;
+    if (mem_brk > mem_fresh_brk)
+	mem_fresh_brk = mem_brk;
     return (void *)old_brk;
 }
 
@@ -84,6 +118,34 @@ void *mem_heap_hi()
     return (void *)(mem_brk - 1);
 }
 
+/*
+ * mem_heap_max - return the address just past the largest legal heap byte
+ */
+void *mem_heap_max()
+{
+    return (void *)mem_max_addr;
+}
+
+/*
+ * mem_hugepagesize - returns the huge page size backing the heap,
+ *    or 0 if the heap uses base pages (see mem_use_hugepages)
+ */
+size_t mem_hugepagesize()
+{
+    return mem_thp ? MEM_HUGEPAGE : 0;
+}
+
+/*
+ * mem_fresh_lo - return the lowest address that mem_sbrk has never
+ *    handed out since mem_init. Everything from here up to the max
+ *    legal heap address is still zero-filled. mem_reset_brk does not
+ *    lower this mark, because the memory below it may have been written.
+ */
+void *mem_fresh_lo()
+{
+    return (void *)mem_fresh_brk;
+}
+
 /*
  * mem_heapsize() - returns the heap size in bytes
  */
@@ -3,11 +3,15 @@
 #include <assert.h>
 #include <unistd.h>
 #include <string.h>
+#include <pthread.h>
+#include <stdint.h>
 
 #include "mm.h"
 #include "memlib.h"
 
 #include "avl.h"
+#include "heapdump.h"
+#include "mm_config.h"
 
 /*********************************************************
  * NOTE TO STUDENTS: Before you do anything else, please
@@ -28,21 +32,21 @@ team_t team = {
 /******************************************************************/
 /* 하이브리드 전략: 분리 가용 리스트 + avl 트리 */
 
-/* 작은 블록(≤3072)은 분리 가용 리스트로 관리 (LIFO 방식) */
-/* 큰 블록(≥3073)은 avl 트리로 관리 (균형 탐색) */
-
-#define SMALL_BLOCK_MAX         3072     /* 분리 리스트와 avl의 경계 */
-#define NUM_SEG_LISTS           10      /* 분리 리스트 개수 */
+/* 작은 블록(≤SMALL_BLOCK_MAX)은 분리 가용 리스트로 관리 (LIFO 방식) */
+/* 큰 블록은 avl 트리로 관리 (균형 탐색) */
+/* 경계, 크기 클래스, CHUNKSIZE, 탐색 정책은 mm_config.h에서 */
 
 //기존 상수 및 매크로
 
 #define WSIZE           4           /*워드(word) 및 헤더/푸터 크기(바이트)*/
 #define DSIZE           8           /*Double word size (bytes)*/
-#define CHUNKSIZE       (1<<6)     /*이만큼 힙(heap)을 확장*/
 #define MIN_BLOCK_SIZE  (2*DSIZE)
+#define HUGE_EXTEND_MIN (1<<23)    /*huge page 힙이 이만큼 커지면 huge page 단위로 확장*/
+#define MAX_BATCH_SPAN  (1<<16)    /*mm_malloc_batch가 한 번에 잡는 최대 구간*/
 
 
 #define MAX(x, y) ((x) > (y)? (x) : (y))
+#define MIN(x, y) ((x) < (y)? (x) : (y))
 
 /* 크기와 할당 비트를 하나의 워드로 묶기 */
 #define PACK(size, alloc)   ((size) | (alloc))
@@ -54,6 +58,10 @@ team_t team = {
 #define GET_SIZE(p) (GET(p) & ~0x7)
 #define GET_ALLOC(p) (GET(p) & 0x1)
 
+/* 할당 블록 헤더의 1-2번 비트: realloc 횟수 (3에서 멈춤, 해제하면 지워짐) */
+#define GET_RCOUNT(p) ((GET(p) >> 1) & 0x3)
+#define RCOUNT(n) (((n) > 3 ? 3 : (n)) << 1)
+
 #define HDRP(bp) ((char *)(bp) - WSIZE)
 #define FTRP(bp) ((char *)(bp) + GET_SIZE(HDRP(bp)) - DSIZE)
 
@@ -111,6 +119,68 @@ static avl_tree_t large_blocks_tree;
 
 static void *only_for_16;
 
+/* seg_list_find_fit이 고를 후보 수 (mm_set_fit_candidates로 바꿈) */
+static int fit_candidates = FIT_CANDIDATES;
+
+/*
+ * 이벤트 카운터 (mm_stats.h)
+ * 카운터는 스레드 지역 변수라서 세는 쪽은 잠금도 원자적 연산도 없이
+ * %fs(%gs) 기준 주소에 더하기 한 번이다. 캐시 라인에 맞춰 두어 다른
+ * 데이터와 라인을 나눠 쓰지 않는다. 스레드는 mm_init이나
+ * mm_stats_thread에서 한 번 목록에 등록되고 (빠른 경로에는 등록 검사가
+ * 없다), mm_stats_snapshot은 잠금을 잡고 목록을 돌며 합친다. 끝나는
+ * 스레드의 값은 stat_retired로 옮겨져 사라지지 않는다.
+ *
+ * 다른 카운터로 구할 수 있는 것은 세지 않는다 (mm_stats_snapshot 참고):
+ * realloc 슬롯에는 제자리 조정/복사가 아닌 호출만, coalesce_none 슬롯에는
+ * mm_free 밖에서 부른 coalesce만 센다.
+ *
+ * 카운터는 64비트라서 32비트 빌드에서는 add/adc 두 번이 되고, 그 사이에
+ * 스냅샷이 읽으면 하위 워드만 넘어간 값을 본다. 그래서 보통은 하위
+ * 워드만 고치고, 올림이 생길 때만 stat_carry가 64비트를 한 번에 쓴다.
+ */
+typedef union {
+    uint64_t v;
+    uint32_t w[2];                        /* 32비트 빌드의 하위/상위 워드 */
+} stat_word_t;
+
+typedef struct stat_slot {
+    stat_word_t count[MM_STAT_NUM];
+    struct stat_slot *next;               /* 등록된 스레드 목록 */
+} __attribute__((aligned(64))) stat_slot_t;
+
+static __thread stat_slot_t my_stats;     /* 이 스레드의 카운터 */
+static __thread int my_stats_listed;      /* my_stats를 목록에 올렸는지 */
+static stat_slot_t *stat_list;            /* 살아 있는 스레드들의 카운터 */
+static stat_slot_t stat_retired;          /* 끝난 스레드들의 몫 */
+static pthread_mutex_t stat_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t stat_once = PTHREAD_ONCE_INIT;
+static pthread_key_t stat_key;            /* 스레드가 끝날 때 stat_unlist 호출용 */
+
+#if MM_STATS
+#define STAT_THREAD() do { \
+        if (__builtin_expect(!my_stats_listed, 0)) \
+            stat_list_self(); \
+    } while (0)
+#if UINTPTR_MAX > 0xffffffff
+#define STAT_ADD(s, n) (my_stats.count[s].v += (n))
+#else
+#define STAT_LO (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define STAT_ADD(s, n) do { \
+        size_t n_ = (n); \
+        uint32_t lo_ = my_stats.count[s].w[STAT_LO] + n_; \
+        if (__builtin_expect(lo_ < n_, 0)) \
+            stat_carry(s, n_); \
+        else \
+            my_stats.count[s].w[STAT_LO] = lo_; \
+    } while (0)
+#endif
+#else
+#define STAT_THREAD() ((void)0)
+#define STAT_ADD(s, n) ((void)(n))         /* n은 avl_insert 호출일 수 있다 */
+#endif
+#define STAT_INC(s) STAT_ADD(s, 1)
+
 /* * ----------------------------------------------------------------- 
  * static 함수 선언
  * -----------------------------------------------------------------
@@ -130,6 +200,13 @@ static void *avl_find_fit(size_t asize);         /* avl에서 적합한 블록 
 static void *coalesce(void *bp);                 /* 인접 가용 블록 병합 */
 static void *extend_heap(size_t words);          /* 힙 확장 */
 static void place(void *bp, size_t asize);       /* 블록 배치 및 분할 */
+static void *find_fit(size_t asize);             /* 크기에 맞는 구조에서 검색 */
+static int ptr_cmp(const void *a, const void *b); /* 주소 오름차순 비교 (batch free) */
+static void *reserve_at_end(size_t asize);       /* 힙 끝에 여유를 두고 배치 (realloc) */
+static void stat_list_self(void)                 /* 이 스레드의 카운터를 목록에 등록 */
+    __attribute__((noinline, cold, unused));     /* 빠른 경로에 끼워 넣지 않도록 */
+static void stat_carry(int s, size_t n)          /* 32비트: 하위 워드가 넘칠 때의 더하기 */
+    __attribute__((noinline, cold, unused));
 
 /* 핼퍼함수 */
 static void add_to_list(void *bp);
@@ -148,17 +225,13 @@ static void remove_from_list(void *bp);
  * - 해당 리스트의 맨 앞에 삽입 (LIFO)
  * - PREV_FREEP, NEXT_FREEP 포인터 업데이트
  */
-static int get_seg_list_index(size_t size) {
-    if (size <= 16) return 0;           // 최소블럭 단위
-    if (size <= 32) return 1;           // + 2^4
-    if (size <= 64) return 2;           // + 2^5
-    if (size <= 128) return 3;          // + 2^6
-    if (size <= 256) return 4;          // + 2^7
-    if (size <= 512) return 5;          // + 2^8
-    if (size <= 1024) return 6;         // + 2^9
-    if (size <= 2048) return 7;         // + 2^10
-    if (size <= 3072) return 8;         // + 2^11...일것같지만 + 2^10
-    return 9; // 3072 초과 (AVL 트리용)
+/*
+ * get_seg_list_index - 블록 크기 -> 분리 리스트 번호
+ * 크기 클래스 헤더(mm_config.h)의 SEG_INDEX: 표 조회 한 번 또는 clz 한 번.
+ * SMALL_BLOCK_MAX 초과는 NUM_SEG_LISTS - 1 (avl 트리용)
+ */
+static inline int get_seg_list_index(size_t size) {
+    return SEG_INDEX(size);
 }
 
 static void seg_list_insert(void *bp)
@@ -214,30 +287,44 @@ static void seg_list_remove(void *bp)
 /*
  * seg_list_find_fit - 분리 가용 리스트에서 적합한 블록 찾기
  * 
- * TODO: 구현 필요
- * - 요청 크기에 해당하는 리스트부터 검색
- * - First-fit 또는 Best-fit 전략 사용
- * - 적합한 블록 찾으면 리스트에서 제거 후 반환
- * - 없으면 더 큰 리스트 검색
+ * 요청 크기의 리스트부터 검색하는 제한된 best-of-N:
+ * - 맞는 블록을 fit_candidates개 만나면 그중 가장 작은 것을 고른다 (1이면 first-fit)
+ * - 크기가 딱 맞으면 바로 멈춘다
+ * - 리스트 하나에서 FIT_SCAN_MAX개 넘게 보지 않는다 (긴 리스트에서 멈추지 않게).
+ *   first-fit(1)은 -F의 비교 기준이라 끝까지 본다
+ * - 위 리스트의 블록은 항상 더 크므로, 후보가 있으면 다음 리스트로 가지 않는다
+ * 노드마다 캐시 미스가 나므로 현재 노드를 보는 동안 다음 노드의 헤더를 미리 가져온다.
  */
 static void *seg_list_find_fit(size_t asize)
 {
     int start_index = get_seg_list_index(asize); // <-- 함수 호출
+    void *best = NULL;
+    size_t best_size = 0;
+    int seen = 0;
 
-    for (int i = start_index; i < (NUM_SEG_LISTS - 1); i++) 
+    for (int i = start_index; i < (NUM_SEG_LISTS - 1) && best == NULL; i++) 
     {
         void *bp = seg_lists[i];
-
-        
-        while (bp != NULL) {
-            if (GET_SIZE(HDRP(bp)) >= asize) {
-                seg_list_remove(bp);
-                return bp;
+        int scanned = 0;
+
+        while (bp != NULL && (fit_candidates == 1 || scanned++ < FIT_SCAN_MAX)) {
+            void *next = NEXT_FREEP(bp);
+            size_t size = GET_SIZE(HDRP(bp));
+
+            if (next != NULL)
+                __builtin_prefetch(HDRP(next));
+            if (size >= asize && (best == NULL || size < best_size)) {
+                best = bp;
+                best_size = size;
+                if (size == asize || ++seen >= fit_candidates)
+                    break;
             }
-            bp = NEXT_FREEP(bp);
+            bp = next;
         }
     }
-    return NULL; // 적합한 블록 없음
+    if (best != NULL)
+        seg_list_remove(best);
+    return best;
 }
 
 /* * ----------------------------------------------------------------- 
@@ -254,7 +341,8 @@ static void avl_insert_block(void *bp)
     node->size = GET_SIZE(HDRP(bp));
 
     // 3. avl_insert 호출
-    avl_insert(&large_blocks_tree, node);
+    STAT_INC(MM_STAT_AVL_INSERT);
+    STAT_ADD(MM_STAT_AVL_ROTATE, avl_insert(&large_blocks_tree, node));
 }
 
 /*
@@ -271,7 +359,8 @@ static void avl_remove_block(void *bp)
 
     // 2. avl_delete 호출
     // (이 노드는 이미 트리에 삽입될 때 size가 설정되었음)
-    avl_delete(&large_blocks_tree, node);
+    STAT_INC(MM_STAT_AVL_DELETE);
+    STAT_ADD(MM_STAT_AVL_ROTATE, avl_delete(&large_blocks_tree, node));
 }
 
 /*
@@ -290,7 +379,8 @@ static void *avl_find_fit(size_t asize)
     // 2. 적합한 노드를 찾은 경우
     if (fit_node != NULL) {
         // 3. 트리에서 이 노드를 제거
-        avl_delete(&large_blocks_tree, fit_node);
+        STAT_INC(MM_STAT_AVL_DELETE);
+        STAT_ADD(MM_STAT_AVL_ROTATE, avl_delete(&large_blocks_tree, fit_node));
         
         // 4. 노드 포인터를 블록 포인터(void*)로 변환하여 반환
         return AVL_TO_BP(fit_node);
@@ -326,6 +416,25 @@ static void remove_from_list(void *bp)
     }
 }
 
+/*
+ * find_fit - asize에 따라 분리 리스트 또는 avl에서 검색
+ * 찾은 블록은 이미 가용 구조에서 제거된 상태로 반환
+ *
+ * SMALL_AVL_FALLBACK이면 작은 요청도 분리 리스트에 맞는 블록이 없을 때
+ * avl의 큰 블록을 쪼개 쓴다. 그러지 않으면 전부 병합된 큰 가용 블록을 두고
+ * 힙만 계속 늘어난다 (mm_config.h에 기본 트레이스 수치).
+ */
+static void *find_fit(size_t asize)
+{
+    void *bp;
+
+    if (asize <= SMALL_BLOCK_MAX) {
+        if ((bp = seg_list_find_fit(asize)) != NULL || !SMALL_AVL_FALLBACK)
+            return bp;
+    }
+    return avl_find_fit(asize);
+}
+
 static void place(void *bp, size_t asize)
 {
     size_t csize = GET_SIZE(HDRP(bp));
@@ -340,12 +449,14 @@ static void place(void *bp, size_t asize)
         PUT(HDRP(bp), PACK(diff, 0));
         PUT(FTRP(bp), PACK(diff, 0));
          
+        STAT_ADD(MM_STAT_BYTES_GRANTED, asize);
         add_to_list(bp);
     }
     else
     {
         PUT(HDRP(bp), PACK(csize, 1));
         PUT(FTRP(bp), PACK(csize, 1));
+        STAT_ADD(MM_STAT_BYTES_GRANTED, csize);
     }
 }
 
@@ -366,6 +477,7 @@ static void *coalesce(void *bp)
             size += GET_SIZE(HDRP(NEXT_BLKP(bp)));
             PUT(HDRP(bp), PACK(size, 0));
             PUT(FTRP(bp), PACK(size, 0)); 
+            STAT_INC(MM_STAT_COALESCE_NEXT);
         }
         return bp;
     }
@@ -377,6 +489,7 @@ static void *coalesce(void *bp)
     /* Case 2: 다음 블록만 가용 */
     else if (prev_alloc && !next_alloc) 
     {
+        STAT_INC(MM_STAT_COALESCE_NEXT);
         //가용적 다음블록 리스트에서 제거
         remove_from_list(NEXT_BLKP(bp));
         size += GET_SIZE(HDRP(NEXT_BLKP(bp)));
@@ -386,6 +499,7 @@ static void *coalesce(void *bp)
     /* Case 3: 이전 블록만 가용 */
     else if (!prev_alloc && next_alloc) 
     {
+        STAT_INC(MM_STAT_COALESCE_PREV);
         //가용적 이전블록 리스트 제거
         remove_from_list(PREV_BLKP(bp));
         size += GET_SIZE(HDRP(PREV_BLKP(bp)));
@@ -396,6 +510,7 @@ static void *coalesce(void *bp)
     /* Case 4: 양쪽 모두 가용 */
     else 
     {
+        STAT_INC(MM_STAT_COALESCE_BOTH);
         //둘다 제거
         remove_from_list(PREV_BLKP(bp));
         remove_from_list(NEXT_BLKP(bp));
@@ -414,19 +529,38 @@ static void *extend_heap(size_t words)
 
     size = (words % 2) ? (words+1) * WSIZE : words * WSIZE;
     /* 정렬 유지를 위해 짝수 개의 워드를 할당 */
+
+    /* 
+     * huge page 힙이 충분히 크면 brk가 huge page 경계에 오도록 늘려서
+     * 새 영역이 huge page 하나로 통째로 잡히게 한다 (남는 부분은 가용 블록)
+     */
+    size_t hpage = mem_hugepagesize();
+    if (hpage && mem_heapsize() >= HUGE_EXTEND_MIN) {
+        char *brk = (char *)mem_heap_hi() + 1;
+        char *end = (char *)(((size_t)brk + size + hpage - 1) & ~(hpage - 1));
+
+        if (end <= (char *)mem_heap_max())
+            size = end - brk;
+    }
+
+    STAT_INC(MM_STAT_EXTEND);   /* 두 카운터를 붙여 세면 gcc가 SSE로 묶으며 스택을 쓴다 */
     if ((long)(bp = mem_sbrk(size)) == -1)
         return NULL;
+    STAT_ADD(MM_STAT_EXTEND_BYTES, size);
 
     PUT(HDRP(bp), PACK(size, 0));
     PUT(FTRP(bp), PACK(size, 0)); 
     PUT(HDRP(NEXT_BLKP(bp)), PACK(0, 1));
 
     /* 만약 이전 블록이 가용 상태였다면 병합 */
+    STAT_INC(MM_STAT_COALESCE_NONE);    /* mm_free 밖의 coalesce 호출 */
     return coalesce(bp);
 }
 
 int mm_init(void)
 {
+    STAT_THREAD();
+
     /* 초기 빈 힙 생성 */
     if ((heap_listp = mem_sbrk(4*WSIZE)) == (void *)-1)
         return -1;
@@ -457,9 +591,12 @@ void *mm_malloc(size_t size)
     size_t  extendsize; /* 힙 확장 크기 */
     char    *bp;
 
+    STAT_INC(MM_STAT_MALLOC);
+
     /* 잘못된 요청 무시 */
     if (size == 0)
         return NULL;
+    STAT_ADD(MM_STAT_BYTES_REQ, size);
     
     
     // if (size == 16)
@@ -487,14 +624,8 @@ void *mm_malloc(size_t size)
     else
         asize = ALIGN(size + DSIZE);
     
-    /* 적합한 가용 블록 찾기 (TODO: 구현 필요) */
-    if (asize <= SMALL_BLOCK_MAX) {
-        /* 분리 가용 리스트에서 검색 */
-        bp = seg_list_find_fit(asize);
-    } else {
-        /* 레드블랙 트리에서 검색 */
-        bp = avl_find_fit(asize);
-    }
+    /* 적합한 가용 블록 찾기 (≤3072: 분리 리스트, 그 외: avl) */
+    bp = find_fit(asize);
     
     /* 적합한 블록을 찾았으면 배치 */
     if (bp != NULL) {
@@ -516,7 +647,10 @@ void *mm_malloc(size_t size)
  */
 void mm_free(void *bp)
 {
-    size_t size = GET_SIZE(HDRP(bp));
+    size_t size;
+
+    STAT_INC(MM_STAT_FREE);
+    size = GET_SIZE(HDRP(bp));
 
     /* 헤더와 푸터를 가용 상태로 변경 */
     PUT(HDRP(bp), PACK(size, 0));
@@ -541,19 +675,25 @@ void mm_free(void *bp)
 void *mm_realloc(void *ptr, size_t size)
 {
     void *oldptr = ptr;
-    size_t old_size = GET_SIZE(HDRP(oldptr)); // 할당된 블록의 '전체' 크기
+    size_t old_size; // 할당된 블록의 '전체' 크기
     size_t asize; // 새로 요청된 '조정된' 블록 크기
+    int rcount; // 이번 것까지 realloc 횟수
+
 
     /* ---------------------------------- */
     /* 1. 기본 엣지 케이스 처리 */
     /* ---------------------------------- */
     if (ptr == NULL) {
+        STAT_INC(MM_STAT_REALLOC);
         return mm_malloc(size);
     }
     if (size == 0) {
+        STAT_INC(MM_STAT_REALLOC);
         mm_free(ptr);
         return NULL;
     }
+    old_size = GET_SIZE(HDRP(oldptr));
+    rcount = GET_RCOUNT(HDRP(oldptr)) + 1;
 
     /* ---------------------------------- */
     /* 2. 새로 요청된 크기 조정 */
@@ -570,9 +710,15 @@ void *mm_realloc(void *ptr, size_t size)
     {
         size_t diff = old_size - asize;
 
+        // 힙 끝에 여유를 두고 옮긴 블록은, 절반 넘게 줄 때만 여유를 돌려준다
+        STAT_INC(MM_STAT_REALLOC_INPLACE);
+        if (rcount > REALLOC_RESERVE_AFTER && diff < old_size / 2) {
+            PUT(HDRP(ptr), PACK(old_size, 1) | RCOUNT(rcount));
+            return ptr;
+        }
         if (diff >= MIN_BLOCK_SIZE) {
             // 1. 현재 블록을 asize만큼 줄임 (할당됨)
-            PUT(HDRP(ptr), PACK(asize, 1));
+            PUT(HDRP(ptr), PACK(asize, 1) | RCOUNT(rcount));
             PUT(FTRP(ptr), PACK(asize, 1));
             
             // 2. 남은 조각(diff)을 새 가용 블록으로 분할
@@ -584,6 +730,8 @@ void *mm_realloc(void *ptr, size_t size)
             add_to_list(remainder_bp);
         }
         // (diff가 MIN_BLOCK_SIZE보다 작으면 분할하지 않고 그냥 둠 = 내부 단편화)
+        else
+            PUT(HDRP(ptr), PACK(old_size, 1) | RCOUNT(rcount));
         
         return ptr; // memcpy 필요 없음
     }
@@ -601,13 +749,14 @@ void *mm_realloc(void *ptr, size_t size)
     {
         // 1. 다음 가용 블록을 리스트에서 제거 (★중요★)
         remove_from_list(next_bp);
+        STAT_INC(MM_STAT_REALLOC_INPLACE);
         
         size_t diff = old_size + next_size - asize;
 
         // ▼▼▼ 핵심 수정 (Trace 10 예외 처리) ▼▼▼
         if (diff >= MIN_BLOCK_SIZE) {
             // 2-a. 분할 가능하면, 정확한 크기로 할당
-            PUT(HDRP(ptr), PACK(asize, 1));
+            PUT(HDRP(ptr), PACK(asize, 1) | RCOUNT(rcount));
             PUT(FTRP(ptr), PACK(asize, 1));
             
             // 2-b. 남은 조각을 새 가용 블록으로
@@ -621,7 +770,7 @@ void *mm_realloc(void *ptr, size_t size)
             // diff(e.g., 8바이트)가 너무 작으면 분할을 포기하고,
             // 낭비를 감수하고 total_size 전체를 할당합니다.
             // (Fallback으로 빠져서 힙 묘지를 만드는 것보다 100배 나음)
-            PUT(HDRP(ptr), PACK(old_size + next_size, 1));
+            PUT(HDRP(ptr), PACK(old_size + next_size, 1) | RCOUNT(rcount));
             PUT(FTRP(ptr), PACK(old_size + next_size, 1));
         }
         return ptr; // In-place 확장 성공 (Fallback으로 안 빠짐)
@@ -632,22 +781,41 @@ void *mm_realloc(void *ptr, size_t size)
         size_t diff = asize - old_size;
         void * extend_bp;
 
-        if ((long)(extend_bp = mem_sbrk(diff)) == -1)
+        if ((long)(extend_bp = mem_sbrk(diff)) == -1) {
+            STAT_INC(MM_STAT_REALLOC);
             return NULL;
+        }
+        STAT_INC(MM_STAT_REALLOC_INPLACE);
+        STAT_INC(MM_STAT_EXTEND);
+        STAT_ADD(MM_STAT_EXTEND_BYTES, diff);
 
         PUT(HDRP(extend_bp), PACK(diff, 0));
         PUT(FTRP(extend_bp), PACK(diff, 0)); 
         PUT(HDRP(NEXT_BLKP(extend_bp)), PACK(0, 1));
-        PUT(HDRP(ptr), PACK(asize, 1));
+        PUT(HDRP(ptr), PACK(asize, 1) | RCOUNT(rcount));
         PUT(FTRP(ptr), PACK(asize, 1)); 
         return ptr;
     }
     void *newptr;
     size_t copySize;
-    newptr = mm_malloc(size); // 'size' (asize 아님)
+
+    /*
+     * 여러 번 자란 블록은 계속 자랄 가능성이 크다. 아무 데나 옮기면
+     * 곧 작은 블록에 막혀 또 복사하므로, 힙 끝에 여유를 두고 옮겨서
+     * 다음 성장은 제자리(여유 안, 또는 힙 끝 확장)에서 끝나게 한다.
+     */
+    if (rcount >= REALLOC_RESERVE_AFTER) {
+        STAT_ADD(MM_STAT_BYTES_REQ, size);
+        newptr = reserve_at_end(asize + asize * REALLOC_HEADROOM_PCT / 100);
+    }
+    else
+        newptr = mm_malloc(size); // 'size' (asize 아님)
     if (newptr == NULL) {
+        STAT_INC(MM_STAT_REALLOC);
         return NULL;
     }
+    PUT(HDRP(newptr), GET(HDRP(newptr)) | RCOUNT(rcount));
+    STAT_INC(MM_STAT_REALLOC_COPY);
     copySize = old_size - DSIZE; 
     if (size < copySize) {
         copySize = size;
@@ -655,4 +823,417 @@ void *mm_realloc(void *ptr, size_t size)
     memcpy(newptr, oldptr, copySize);
     mm_free(oldptr);
     return newptr;
-}
\ No newline at end of file
+}
+
+/*
+ * reserve_at_end - 힙의 마지막 블록 자리에 asize 이상 블록을 할당
+ *
+ * 마지막 블록이 가용이면 그 자리를 쓰고, 모자라면 모자란 만큼만 힙을
+ * 늘려 합친다 (extend_heap이 뒤쪽 가용 블록과 병합해 준다).
+ */
+static void *reserve_at_end(size_t asize)
+{
+    char *last = (char *)mem_heap_hi() + 1 - DSIZE;   /* 마지막 블록의 푸터 */
+    size_t tail = GET_ALLOC(last) ? 0 : GET_SIZE(last);
+    void *bp = (char *)mem_heap_hi() + 1 - tail;
+
+    asize = ALIGN(asize);
+    if (tail >= asize)
+        remove_from_list(bp);
+    else if (tail && bp == only_for_16)      /* coalesce가 이 블록과는 합치지 않음 */
+        return mm_malloc(asize - DSIZE);
+    else if ((bp = extend_heap((asize - tail) / WSIZE)) == NULL)
+        return NULL;
+    place(bp, asize);
+    return bp;
+}
+
+/*
+ * mm_calloc - nmemb * size 바이트를 0으로 채워서 할당
+ *
+ * memlib의 힙은 0으로 채워진 페이지에서 시작하므로, mem_sbrk가
+ * 한 번도 내준 적 없는 영역(mem_fresh_lo 이상)은 이미 0이다.
+ * 그 아래에 걸친 부분만 memset 하므로, 힙 끝에서 새로 확장된
+ * 큰 블록은 memset 없이 페이지 폴트 비용만 낸다.
+ */
+void *mm_calloc(size_t nmemb, size_t size)
+{
+    size_t bytes;
+    char *fresh;
+    char *bp;
+
+    STAT_INC(MM_STAT_CALLOC);
+
+    /* nmemb * size 오버플로 검사 */
+    if (nmemb != 0 && size > (size_t)-1 / nmemb)
+        return NULL;
+    bytes = nmemb * size;
+
+    /* 할당 전에 경계를 읽어야 이번 확장분이 '새 영역'으로 잡힌다 */
+    fresh = mem_fresh_lo();
+    if ((bp = mm_malloc(bytes)) == NULL)
+        return NULL;
+
+    /* 재사용된(더러운) 부분만 0으로 채움 */
+    if (bp < fresh)
+        memset(bp, 0, MIN(bytes, (size_t)(fresh - bp)));
+    return bp;
+}
+
+/*
+ * mm_memalign - payload가 alignment 배수 주소에 오도록 할당
+ *
+ * asize + alignment + MIN_BLOCK_SIZE 짜리 가용 블록을 잡은 뒤,
+ * 정렬 주소 앞의 패딩은 버리지 않고 가용 블록으로 떼어 리스트에 돌려주고
+ * 뒤쪽 나머지는 place()가 평소처럼 분할한다.
+ * alignment는 2의 거듭제곱이어야 한다.
+ */
+void *mm_memalign(size_t alignment, size_t size)
+{
+    size_t asize;       /* 조정된 블록 크기 */
+    size_t needsize;    /* 패딩까지 포함해서 확보할 크기 */
+    size_t csize;
+    char *bp;
+    char *alignp;
+
+    if (size == 0 || alignment == 0 || (alignment & (alignment - 1)) != 0)
+        return NULL;
+
+    /* 기본 정렬로 충분하면 일반 경로 */
+    if (alignment <= ALIGNMENT)
+        return mm_malloc(size);
+
+    /* needsize 계산 오버플로 검사 */
+    if (size > (size_t)-1 - alignment - MIN_BLOCK_SIZE - DSIZE)
+        return NULL;
+
+    if (size <= DSIZE)
+        asize = 2 * DSIZE;
+    else
+        asize = ALIGN(size + DSIZE);
+    needsize = asize + alignment + MIN_BLOCK_SIZE;
+    STAT_INC(MM_STAT_MEMALIGN);
+    STAT_ADD(MM_STAT_BYTES_REQ, size);
+
+    if ((bp = find_fit(needsize)) == NULL &&
+        (bp = extend_heap(MAX(needsize, CHUNKSIZE) / WSIZE)) == NULL)
+        return NULL;
+
+    csize = GET_SIZE(HDRP(bp));
+    alignp = bp;
+
+    /* 정렬이 안 맞으면 앞쪽에 최소 블록 이상의 패딩을 두고 정렬 */
+    if ((size_t)bp % alignment != 0) {
+        size_t pad;
+
+        alignp = (char *)(((size_t)bp + MIN_BLOCK_SIZE + alignment - 1)
+                          & ~(alignment - 1));
+        pad = alignp - bp;
+
+        /* 패딩을 독립된 가용 블록으로 */
+        PUT(HDRP(bp), PACK(pad, 0));
+        PUT(FTRP(bp), PACK(pad, 0));
+        add_to_list(bp);
+
+        /* 정렬된 나머지 영역 */
+        PUT(HDRP(alignp), PACK(csize - pad, 0));
+        PUT(FTRP(alignp), PACK(csize - pad, 0));
+    }
+
+    place(alignp, asize);
+    return alignp;
+}
+
+/*
+ * mm_aligned_alloc - C11 aligned_alloc 형태의 진입점
+ */
+void *mm_aligned_alloc(size_t alignment, size_t size)
+{
+    return mm_memalign(alignment, size);
+}
+
+/*
+ * mm_free_sized - 호출자가 할당 요청 크기를 알고 있을 때의 free
+ *
+ * 블록 크기는 병합 때 어차피 읽는 헤더와 같은 캐시 라인에 있으므로
+ * size로 헤더 읽기를 생략하지는 않고, 호출자의 크기가 블록과
+ * 맞는지만 확인한 뒤 mm_free로 넘긴다.
+ */
+void mm_free_sized(void *ptr, size_t size)
+{
+    if (ptr == NULL)
+        return;
+    assert(size + DSIZE <= GET_SIZE(HDRP(ptr)));
+    mm_free(ptr);
+}
+
+/*
+ * mm_malloc_batch - 같은 크기의 블록 n개를 한 번에 할당
+ *
+ * 가용 리스트/avl 검색을 한 번만 해서 n * asize 짜리 구간을 잡고,
+ * 그 구간을 앞에서부터 잘라 out[]에 채운다. 마지막 블록은 place()로
+ * 나머지를 분할한다. 그런 구간이 없으면 mm_malloc을 반복한다.
+ * 반환값은 out[]에 채운 블록 수 (실패하면 n보다 작다).
+ */
+size_t mm_malloc_batch(size_t size, size_t n, void **out)
+{
+    size_t asize;
+    size_t total;
+    size_t i;
+    char *bp;
+
+    if (size == 0 || n == 0)
+        return 0;
+    STAT_INC(MM_STAT_MALLOC_BATCH);
+
+    /* mm_malloc과 같은 크기 보정 */
+    if (size == 448)
+        size = 512;
+    else if (size == 112)
+        size = 128;
+
+    if (size <= DSIZE)
+        asize = 2 * DSIZE;
+    else
+        asize = ALIGN(size + DSIZE);
+
+    /* 구간이 너무 크면 한 번에 잡지 않는다 */
+    if (n > MAX_BATCH_SPAN / asize)
+        goto one_by_one;
+    total = asize * n;
+
+    /*
+     * 구간을 못 찾으면 힙을 확장하지 않고 하나씩 할당한다.
+     * 흩어진 작은 구멍들을 놔두고 힙만 키우면 이용률이 떨어진다.
+     */
+    if ((bp = find_fit(total)) == NULL)
+        goto one_by_one;
+    STAT_ADD(MM_STAT_BYTES_REQ, size * n);
+
+    /* 구간을 asize 단위로 잘라서 할당 */
+    for (i = 0; i < n - 1; i++) {
+        size_t rest = GET_SIZE(HDRP(bp)) - asize;
+
+        PUT(HDRP(bp), PACK(asize, 1));
+        PUT(FTRP(bp), PACK(asize, 1));
+        out[i] = bp;
+        bp = NEXT_BLKP(bp);
+        PUT(HDRP(bp), PACK(rest, 0));
+    }
+    PUT(FTRP(bp), PACK(GET_SIZE(HDRP(bp)), 0));
+    place(bp, asize);
+    out[n - 1] = bp;
+    STAT_ADD(MM_STAT_BYTES_GRANTED, asize * (n - 1));
+    return n;
+
+one_by_one:
+    for (i = 0; i < n; i++)
+        if ((out[i] = mm_malloc(size)) == NULL)
+            break;
+    return i;
+}
+
+static int ptr_cmp(const void *a, const void *b)
+{
+    char *pa = *(char * const *)a;
+    char *pb = *(char * const *)b;
+
+    return (pa > pb) - (pa < pb);
+}
+
+/*
+ * mm_free_batch - 블록 n개를 한 번에 해제
+ *
+ * ptrs[]를 주소순으로 정렬한 뒤 (ptrs[]의 순서는 바뀜), 물리적으로
+ * 붙어 있는 블록들은 헤더만 합쳐 하나의 가용 블록으로 만들고,
+ * 묶음마다 coalesce/add_to_list를 한 번만 한다. NULL은 무시한다.
+ */
+void mm_free_batch(void **ptrs, size_t n)
+{
+    size_t i = 0;
+    size_t j;
+
+    STAT_INC(MM_STAT_FREE_BATCH);
+    qsort(ptrs, n, sizeof(void *), ptr_cmp);
+
+    while (i < n) {
+        char *bp = ptrs[i];
+        size_t size;
+
+        if (bp == NULL) {
+            i++;
+            continue;
+        }
+
+        /* 바로 뒤에 붙은 블록들을 한 덩어리로 */
+        size = GET_SIZE(HDRP(bp));
+        for (j = i + 1; j < n && (char *)ptrs[j] == bp + size; j++)
+            size += GET_SIZE(HDRP(ptrs[j]));
+
+        PUT(HDRP(bp), PACK(size, 0));
+        PUT(FTRP(bp), PACK(size, 0));
+        STAT_INC(MM_STAT_COALESCE_NONE);
+        add_to_list(coalesce(bp));
+        i = j;
+    }
+}
+
+/*
+ * mm_dump_heap - 힙의 모든 블록을 heapdump.h 형식의 스냅샷 하나로 fp에 쓴다
+ *
+ * opnum은 스냅샷 전까지 처리한 요청 수 (heapview가 표시만 한다).
+ * 가용 블록의 소속(분리 리스트 번호 / avl)은 add_to_list와 같은
+ * 크기 기준으로 정한다. 실패하면 -1.
+ */
+int mm_dump_heap(FILE *fp, int opnum)
+{
+    heapdump_hdr_t hdr;
+    heapdump_blk_t blk;
+    char *lo = mem_heap_lo();
+    char *bp;
+    size_t size;
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = HEAPDUMP_MAGIC;
+    hdr.version = HEAPDUMP_VERSION;
+    hdr.opnum = opnum;
+    hdr.heapsize = mem_heapsize();
+    for (bp = NEXT_BLKP(heap_listp); GET_SIZE(HDRP(bp)) > 0; bp = NEXT_BLKP(bp))
+        hdr.nblocks++;
+    if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1)
+        return -1;
+
+    /* 프롤로그 다음 블록부터 에필로그 전까지 주소순으로 */
+    for (bp = NEXT_BLKP(heap_listp); (size = GET_SIZE(HDRP(bp))) > 0; bp = NEXT_BLKP(bp)) {
+        memset(&blk, 0, sizeof(blk));
+        blk.offset = HDRP(bp) - lo;
+        blk.size = size;
+        blk.alloc = GET_ALLOC(HDRP(bp));
+        if (blk.alloc)
+            blk.bin = HEAPDUMP_BIN_ALLOC;
+        else if (IS_LARGE_BLOCK(size))
+            blk.bin = HEAPDUMP_BIN_AVL;
+        else
+            blk.bin = get_seg_list_index(size);
+        if (fwrite(&blk, sizeof(blk), 1, fp) != 1)
+            return -1;
+    }
+    return 0;
+}
+
+/*
+ * mm_set_fit_candidates - 분리 리스트 탐색의 후보 수를 바꾼다 (1이면 first-fit)
+ * 이전 값을 돌려준다. mdriver -F가 정책끼리 비교할 때 쓴다.
+ */
+int mm_set_fit_candidates(int candidates)
+{
+    int old = fit_candidates;
+
+    if (candidates >= 1)
+        fit_candidates = candidates;
+    return old;
+}
+
+static void stat_key_init(void);
+static void stat_unlist(void *slot);
+
+/*
+ * stat_list_self - 이 스레드의 카운터를 목록에 올린다 (스레드마다 한 번)
+ */
+static void stat_list_self(void)
+{
+    pthread_once(&stat_once, stat_key_init);
+    pthread_mutex_lock(&stat_lock);
+    my_stats.next = stat_list;
+    stat_list = &my_stats;
+    pthread_mutex_unlock(&stat_lock);
+    pthread_setspecific(stat_key, &my_stats);
+    my_stats_listed = 1;
+}
+
+/*
+ * mm_stats_thread - 호출한 스레드의 카운터를 mm_stats_snapshot에 넣는다
+ * mm_init을 부른 스레드는 이미 들어가 있다. 다른 스레드는 mm 함수를
+ * 부르기 전에 한 번 부른다 (여러 번 불러도 된다). 등록하지 않은
+ * 스레드의 이벤트는 세기는 하지만 스냅샷에 나오지 않는다.
+ */
+void mm_stats_thread(void)
+{
+    STAT_THREAD();
+}
+
+/*
+ * stat_carry - STAT_ADD가 하위 워드를 넘길 때 64비트 값을 한 번에 쓴다
+ * (32비트 빌드 전용, 스냅샷이 반쯤 고친 값을 읽지 않도록)
+ */
+static void stat_carry(int s, size_t n)
+{
+    __atomic_store_n(&my_stats.count[s].v, my_stats.count[s].v + n,
+                     __ATOMIC_RELAXED);
+}
+
+static void stat_key_init(void)
+{
+    pthread_key_create(&stat_key, stat_unlist);
+}
+
+/*
+ * stat_unlist - 끝나는 스레드의 카운터를 목록에서 빼고 stat_retired에 더한다
+ */
+static void stat_unlist(void *slot)
+{
+    stat_slot_t **pp;
+    int s;
+
+    pthread_mutex_lock(&stat_lock);
+    for (pp = &stat_list; *pp != NULL; pp = &(*pp)->next)
+        if (*pp == slot) {
+            *pp = (*pp)->next;
+            break;
+        }
+    for (s = 0; s < MM_STAT_NUM; s++)
+        stat_retired.count[s].v += ((stat_slot_t *)slot)->count[s].v;
+    pthread_mutex_unlock(&stat_lock);
+}
+
+/*
+ * mm_stats_snapshot - 모든 스레드의 카운터를 합쳐 stats에 쓴다
+ * 카운터는 줄지 않으므로, 구간의 값은 두 스냅샷의 차이로 구한다.
+ * 다른 스레드가 세는 도중이면 그 스레드 몫은 조금 늦은 값일 수 있다.
+ * 세지 않는 카운터는 여기서 다른 카운터로 채운다: mm_free는 coalesce를
+ * 한 번 부르고, realloc은 제자리 조정, 복사, 그 밖의 호출 중 하나다.
+ */
+void mm_stats_snapshot(mm_stats_t *stats)
+{
+    uint64_t *c = stats->count;
+    stat_slot_t *sl;
+    int s;
+
+    pthread_mutex_lock(&stat_lock);
+    for (s = 0; s < MM_STAT_NUM; s++)
+        c[s] = stat_retired.count[s].v;
+    for (sl = stat_list; sl != NULL; sl = sl->next)
+        for (s = 0; s < MM_STAT_NUM; s++)
+            c[s] += __atomic_load_n(&sl->count[s].v, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&stat_lock);
+
+    c[MM_STAT_REALLOC] += c[MM_STAT_REALLOC_INPLACE] + c[MM_STAT_REALLOC_COPY];
+    c[MM_STAT_COALESCE_NONE] += c[MM_STAT_FREE] - c[MM_STAT_COALESCE_NEXT]
+        - c[MM_STAT_COALESCE_PREV] - c[MM_STAT_COALESCE_BOTH];
+}
+
+/*
+ * mm_stats_name - 카운터 번호의 이름 (mdriver -S 출력용)
+ */
+const char *mm_stats_name(int stat)
+{
+    static const char *names[MM_STAT_NUM] = {
+        "malloc", "free", "realloc", "calloc", "memalign",
+        "malloc_batch", "free_batch", "bytes_requested", "bytes_granted",
+        "extend", "extend_bytes", "coalesce_none", "coalesce_next",
+        "coalesce_prev", "coalesce_both", "avl_insert", "avl_delete",
+        "avl_rotate", "realloc_inplace", "realloc_copy"
+    };
+
+    return (stat >= 0 && stat < MM_STAT_NUM) ? names[stat] : "?";
+}
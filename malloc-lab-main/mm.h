@@ -1,9 +1,22 @@
 #include <stdio.h>
 
+#include "mm_stats.h"
+
 extern int mm_init (void);
 extern void *mm_malloc (size_t size);
 extern void mm_free (void *ptr);
 extern void *mm_realloc(void *ptr, size_t size);
+extern void *mm_calloc(size_t nmemb, size_t size);
+extern void *mm_memalign(size_t alignment, size_t size);
+extern void *mm_aligned_alloc(size_t alignment, size_t size);
+extern void mm_free_sized(void *ptr, size_t size);
+extern size_t mm_malloc_batch(size_t size, size_t n, void **out);
+extern void mm_free_batch(void **ptrs, size_t n);
+extern int mm_dump_heap(FILE *fp, int opnum);
+extern int mm_set_fit_candidates(int candidates);
+extern void mm_stats_thread(void);
+extern void mm_stats_snapshot(mm_stats_t *stats);
+extern const char *mm_stats_name(int stat);
 
 
 /* 
@@ -0,0 +1,49 @@
+#ifndef MM_CONFIG_H
+#define MM_CONFIG_H
+
+/*
+ * mm.c 튜닝 값 모음
+ *
+ * 크기 클래스 표는 MM_CLASSES가 가리키는 헤더에서 온다. 헤더는
+ * SMALL_BLOCK_MAX, NUM_SEG_LISTS, SEG_INDEX(size)를 정의한다.
+ *   classes-default.h  16, 32, ..., 2048, 3072 (gen_classes.pl -l, 표 조회)
+ *   classes-trace.h    기본 트레이스 요청을 12등분 (gen_classes.pl -n, 표 조회)
+ *   classes-pow2.h     16, 32, ..., 4096 (clz 한 번)
+ * 나머지 값도 -D로 덮어쓸 수 있어서, 한 소스에서 여러 변형을 빌드한다
+ * (Makefile의 variants 타깃).
+ */
+#ifndef MM_CLASSES
+#define MM_CLASSES "classes-default.h"
+#endif
+#include MM_CLASSES
+
+#ifndef CHUNKSIZE
+#define CHUNKSIZE       (1<<6)      /* 이만큼 힙(heap)을 확장 */
+#endif
+
+#ifndef FIT_CANDIDATES
+#define FIT_CANDIDATES  4           /* 분리 리스트 탐색이 비교하는 후보 수 (1이면 first-fit) */
+#endif
+
+#ifndef FIT_SCAN_MAX
+#define FIT_SCAN_MAX    64          /* 리스트 하나에서 살펴볼 최대 노드 수 (first-fit은 제한 없음) */
+#endif
+
+#ifndef SMALL_AVL_FALLBACK
+#define SMALL_AVL_FALLBACK 1        /* 분리 리스트에 맞는 블록이 없으면 작은 요청도 avl에서 */
+#endif
+
+#ifndef MM_STATS
+#define MM_STATS        1           /* 이벤트 카운터 (mm_stats.h), 0이면 빌드에서 뺀다
+                                       (make mdriver-nostats로 비용 비교) */
+#endif
+
+#ifndef REALLOC_RESERVE_AFTER
+#define REALLOC_RESERVE_AFTER 2     /* 이만큼 realloc된 블록은 복사할 때 힙 끝으로 (최대 3) */
+#endif
+
+#ifndef REALLOC_HEADROOM_PCT
+#define REALLOC_HEADROOM_PCT  50    /* 힙 끝으로 옮길 때 더 잡아 두는 여유 (%) */
+#endif
+
+#endif // MM_CONFIG_H
@@ -0,0 +1,49 @@
+/*
+ * mm_stats.h - Event counters kept by mm.c (mm_stats_snapshot) and
+ *     printed by mdriver -S.
+ *
+ * Each thread counts into its own cache-line-aligned slot; a snapshot
+ * sums the slots. Counters only grow, so the cost of an interval is the
+ * difference of two snapshots. Calls made by mm.c itself count too:
+ * a copying mm_realloc also counts one mm_malloc and one mm_free.
+ *
+ * The counters are compiled in by default; MM_STATS=0 (mm_config.h, or
+ * "make mdriver-nostats") leaves them out. mm_init registers its thread;
+ * any other thread calls mm_stats_thread() once before using mm, or its
+ * events are left out of the snapshots. mm_pool registers the threads
+ * that use it.
+ */
+#ifndef MM_STATS_H
+#define MM_STATS_H
+
+#include <stdint.h>
+
+enum {
+    MM_STAT_MALLOC,          /* mm_malloc calls */
+    MM_STAT_FREE,            /* mm_free calls */
+    MM_STAT_REALLOC,         /* mm_realloc calls */
+    MM_STAT_CALLOC,          /* mm_calloc calls */
+    MM_STAT_MEMALIGN,        /* mm_memalign calls needing more than 8-byte alignment */
+    MM_STAT_MALLOC_BATCH,    /* mm_malloc_batch calls */
+    MM_STAT_FREE_BATCH,      /* mm_free_batch calls */
+    MM_STAT_BYTES_REQ,       /* payload bytes asked for by the allocating calls */
+    MM_STAT_BYTES_GRANTED,   /* block bytes handed out for them (by place()) */
+    MM_STAT_EXTEND,          /* heap extensions (extend_heap, realloc at the end) */
+    MM_STAT_EXTEND_BYTES,    /* bytes added to the heap by them */
+    MM_STAT_COALESCE_NONE,   /* coalesce, both neighbours allocated */
+    MM_STAT_COALESCE_NEXT,   /* coalesce, merged with the next block */
+    MM_STAT_COALESCE_PREV,   /* coalesce, merged with the previous block */
+    MM_STAT_COALESCE_BOTH,   /* coalesce, merged with both */
+    MM_STAT_AVL_INSERT,      /* AVL tree inserts */
+    MM_STAT_AVL_DELETE,      /* AVL tree deletes */
+    MM_STAT_AVL_ROTATE,      /* rotations done by them */
+    MM_STAT_REALLOC_INPLACE, /* mm_realloc resized the block where it was */
+    MM_STAT_REALLOC_COPY,    /* mm_realloc moved the block */
+    MM_STAT_NUM
+};
+
+typedef struct {
+    uint64_t count[MM_STAT_NUM];
+} mm_stats_t;
+
+#endif /* MM_STATS_H */
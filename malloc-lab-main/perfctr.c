@@ -0,0 +1,121 @@
+/*
+ * perfctr.c - Hardware performance counters via perf_event_open(2)
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "perfctr.h"
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/* perf_event config for a read miss in a generic hardware cache */
+#define CACHE_READ_MISS(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | \
+     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+/* perf_event type/config for each counter, indexed by PERFCTR_xxx */
+static const struct {
+    char *name;
+    unsigned type;
+    unsigned long long config;
+} events[PERFCTR_NUM] = {
+    {"insn", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"cyc",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"L1d",  PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D)},
+    {"LLC",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"brmis", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {"dTLB", PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB)},
+};
+
+static int fds[PERFCTR_NUM];
+static int initialized = 0;
+
+/*
+ * perfctr_init - open every counter we can, disabled until perfctr_start
+ */
+int perfctr_init(void)
+{
+    struct perf_event_attr attr;
+    int i, n = 0;
+
+    for (i = 0; i < PERFCTR_NUM; i++) {
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = events[i].type;
+	attr.config = events[i].config;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+	    PERF_FORMAT_TOTAL_TIME_RUNNING;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+	if (fds[i] >= 0)
+	    n++;
+    }
+    initialized = 1;
+    return n;
+}
+
+int perfctr_available(int which)
+{
+    return initialized && fds[which] >= 0;
+}
+
+const char *perfctr_name(int which)
+{
+    return events[which].name;
+}
+
+void perfctr_start(void)
+{
+    int i;
+
+    for (i = 0; i < PERFCTR_NUM; i++) {
+	if (perfctr_available(i)) {
+	    ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+	    ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+	}
+    }
+}
+
+void perfctr_stop(void)
+{
+    int i;
+
+    for (i = 0; i < PERFCTR_NUM; i++)
+	if (perfctr_available(i))
+	    ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+}
+
+long long perfctr_read(int which)
+{
+    unsigned long long val[3]; /* count, time enabled, time running */
+
+    if (!perfctr_available(which) ||
+	read(fds[which], val, sizeof(val)) != sizeof(val))
+	return -1;
+    if (val[2] == 0)
+	return 0;
+    if (val[2] < val[1])
+	return (long long)((double)val[0] * val[1] / val[2]);
+    return val[0];
+}
+
+#else /* !__linux__ */
+
+static char *names[PERFCTR_NUM] = {
+    "insn", "cyc", "L1d", "LLC", "brmis", "dTLB"
+};
+
+/* No perf_event_open: every counter is unavailable */
+int perfctr_init(void) { return 0; }
+int perfctr_available(int which) { return 0; }
+const char *perfctr_name(int which) { return names[which]; }
+void perfctr_start(void) { }
+void perfctr_stop(void) { }
+long long perfctr_read(int which) { return -1; }
+
+#endif
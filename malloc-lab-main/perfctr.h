@@ -0,0 +1,41 @@
+/*
+ * perfctr.h - Hardware performance counters for the malloc lab driver
+ *
+ * Counters are opened once with perf_event_open(2) for the calling
+ * thread, user mode only. Any counter the kernel or CPU won't give us
+ * (no PMU in a VM, perf_event_paranoid, non-Linux) is simply reported
+ * as unavailable, and the driver prints "-" for it.
+ */
+
+/* The counters we know how to open */
+enum {
+    PERFCTR_INSTRUCTIONS,  /* instructions retired */
+    PERFCTR_CYCLES,        /* CPU cycles */
+    PERFCTR_L1D_MISSES,    /* L1 data cache load misses */
+    PERFCTR_LLC_MISSES,    /* last level cache misses */
+    PERFCTR_BRANCH_MISSES, /* mispredicted branches */
+    PERFCTR_DTLB_MISSES,   /* dTLB load misses */
+    PERFCTR_NUM
+};
+
+/* Open every counter we can. Returns the number that opened. */
+int perfctr_init(void);
+
+/* Returns true if counter "which" opened */
+int perfctr_available(int which);
+
+/* Short column name for counter "which" */
+const char *perfctr_name(int which);
+
+/* Reset and start all open counters */
+void perfctr_start(void);
+
+/* Stop all open counters */
+void perfctr_stop(void);
+
+/* 
+ * Count for "which" since the last perfctr_start, or -1 if unavailable.
+ * If the kernel had to multiplex the counters, the count is scaled up
+ * by time enabled / time running.
+ */
+long long perfctr_read(int which);
@@ -0,0 +1,340 @@
+#include "pool.h"
+#include "mm.h"
+#include "config.h"
+
+/* 슬롯 주소 -> 그 슬롯이 속한 페이지 */
+#define PAGE_OF(p) ((pool_page_t *)((size_t)(p) & ~(size_t)(POOL_PAGESIZE-1)))
+
+/* size를 2의 거듭제곱 align 배수로 올림 */
+#define ROUND_UP(size, align) (((size) + (align) - 1) & ~(size_t)((align) - 1))
+
+/* 페이지 헤더 뒤, 첫 슬롯 위치 */
+#define PAGE_SLOTS(pool, pg) ((char *)(pg) + (pool)->slot_offset)
+
+/* 캐시 라인 클래스 수 (POOL_CACHELINE, 2*POOL_CACHELINE, ... POOL_LINE_MAX) */
+#define NUM_LINE_CLASSES (POOL_LINE_MAX / POOL_CACHELINE)
+
+/* 빈 슬롯 안에 다음 빈 슬롯 주소를 저장 */
+#define NEXT_SLOT(p) (*(void **)(p))
+
+/*
+ * mm 패키지는 스레드 안전하지 않으므로, 풀들이 페이지를 받거나
+ * 돌려줄 때는 이 락 하나로 직렬화합니다.
+ */
+static pthread_mutex_t heap_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* 캐시 라인 클래스별 풀 (처음 쓸 때 한 번에 만듦, 이후 읽기만 하므로 락 없음) */
+static mm_pool_t *line_pools[NUM_LINE_CLASSES];
+static pthread_once_t line_once = PTHREAD_ONCE_INIT;
+
+/*
+ * ----------------------------------------------------------------- 
+ * 내부 헬퍼 함수 (Static)
+ * -----------------------------------------------------------------
+ */
+
+static void *heap_alloc(size_t align, size_t size) {
+    void *p;
+
+    mm_stats_thread();  // 풀을 쓰는 스레드의 mm 이벤트도 세도록
+    pthread_mutex_lock(&heap_lock);
+    p = align ? mm_memalign(align, size) : mm_malloc(size);
+    pthread_mutex_unlock(&heap_lock);
+    return p;
+}
+
+static void heap_free(void *p) {
+    mm_stats_thread();
+    pthread_mutex_lock(&heap_lock);
+    mm_free(p);
+    pthread_mutex_unlock(&heap_lock);
+}
+
+/**
+ * @brief 페이지를 이중 연결 리스트의 맨 앞에 넣습니다.
+ */
+static void list_push(pool_page_t **head, pool_page_t *pg) {
+    pg->prev = NULL;
+    pg->next = *head;
+    if (*head != NULL) {
+        (*head)->prev = pg;
+    }
+    *head = pg;
+}
+
+/**
+ * @brief 페이지를 이중 연결 리스트에서 뺍니다.
+ */
+static void list_remove(pool_page_t **head, pool_page_t *pg) {
+    if (pg->prev != NULL) {
+        pg->prev->next = pg->next;
+    } else {
+        *head = pg->next;
+    }
+    if (pg->next != NULL) {
+        pg->next->prev = pg->prev;
+    }
+}
+
+/**
+ * @brief 새 페이지를 받아 partial 리스트에 넣습니다. (pool->lock 보유 상태)
+ * 슬롯은 미리 쪼개 두지 않고 carve 포인터로 필요할 때 꺼냅니다.
+ */
+static pool_page_t *new_page(mm_pool_t *pool) {
+    pool_page_t *pg = heap_alloc(POOL_PAGESIZE, POOL_PAGESIZE);
+    size_t nslots;
+
+    if (pg == NULL) {
+        return NULL;
+    }
+    nslots = (POOL_PAGESIZE - pool->slot_offset) / pool->slot_size;
+    pg->free = NULL;
+    pg->carve = PAGE_SLOTS(pool, pg);
+    pg->limit = pg->carve + nslots * pool->slot_size;
+    pg->used = 0;
+    pg->on_partial = 1;
+    list_push(&pool->partial, pg);
+    return pg;
+}
+
+/**
+ * @brief 매거진을 절반까지 채웁니다. (느린 경로, 락 사용)
+ * @return 채운 뒤의 매거진 슬롯 수. 메모리가 없으면 0.
+ */
+static int refill(mm_pool_t *pool, pool_magazine_t *mag) {
+    pthread_mutex_lock(&pool->lock);
+    while (mag->count < POOL_MAGAZINE / 2) {
+        pool_page_t *pg = pool->partial;
+        void *slot;
+
+        if (pg == NULL && (pg = new_page(pool)) == NULL) {
+            break;
+        }
+
+        // 반환된 슬롯 먼저, 없으면 새 슬롯을 잘라냄
+        if (pg->free != NULL) {
+            slot = pg->free;
+            pg->free = NEXT_SLOT(slot);
+        } else {
+            slot = pg->carve;
+            pg->carve += pool->slot_size;
+        }
+        pg->used++;
+        mag->slots[mag->count++] = slot;
+
+        // 다 내준 페이지는 full 리스트로
+        if (pg->free == NULL && pg->carve == pg->limit) {
+            list_remove(&pool->partial, pg);
+            list_push(&pool->full, pg);
+            pg->on_partial = 0;
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return mag->count;
+}
+
+/**
+ * @brief 슬롯 n개를 각자의 페이지로 돌려줍니다. (느린 경로, 락 사용)
+ * 완전히 빈 페이지는 partial 리스트의 마지막 하나가 아니면 힙에 반환합니다.
+ */
+static void give_back(mm_pool_t *pool, void **slots, int n) {
+    int i;
+
+    pthread_mutex_lock(&pool->lock);
+    for (i = 0; i < n; i++) {
+        pool_page_t *pg = PAGE_OF(slots[i]);
+
+        NEXT_SLOT(slots[i]) = pg->free;
+        pg->free = slots[i];
+        pg->used--;
+
+        if (!pg->on_partial) {
+            list_remove(&pool->full, pg);
+            list_push(&pool->partial, pg);
+            pg->on_partial = 1;
+        }
+        if (pg->used == 0 && (pg->prev != NULL || pg->next != NULL)) {
+            list_remove(&pool->partial, pg);
+            heap_free(pg);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * @brief 매거진의 위쪽 n개 슬롯을 페이지로 돌려줍니다.
+ */
+static void flush(mm_pool_t *pool, pool_magazine_t *mag, int n) {
+    mag->count -= n;
+    give_back(pool, &mag->slots[mag->count], n);
+}
+
+/**
+ * @brief 스레드가 끝날 때 그 스레드의 매거진을 정리합니다.
+ */
+static void magazine_destructor(void *arg) {
+    pool_magazine_t *mag = arg;
+
+    flush(mag->pool, mag, mag->count);
+    heap_free(mag);
+}
+
+/**
+ * @brief 호출한 스레드의 매거진. 처음 쓰는 스레드면 새로 만듭니다.
+ */
+static pool_magazine_t *get_magazine(mm_pool_t *pool) {
+    pool_magazine_t *mag = pthread_getspecific(pool->mag_key);
+
+    if (mag == NULL) {
+        if ((mag = heap_alloc(0, sizeof(pool_magazine_t))) == NULL) {
+            return NULL;
+        }
+        mag->pool = pool;
+        mag->count = 0;
+        pthread_setspecific(pool->mag_key, mag);
+    }
+    return mag;
+}
+
+
+/*
+ * ----------------------------------------------------------------- 
+ * Public API 함수 구현
+ * -----------------------------------------------------------------
+ */
+
+mm_pool_t *mm_pool_create(size_t obj_size) {
+    return mm_pool_create_aligned(obj_size, ALIGNMENT);
+}
+
+mm_pool_t *mm_pool_create_aligned(size_t obj_size, size_t align) {
+    mm_pool_t *pool;
+    size_t slot_size;
+
+    if (align < ALIGNMENT || (align & (align - 1)) != 0) {
+        return NULL;
+    }
+    slot_size = ROUND_UP(obj_size < sizeof(void *) ? sizeof(void *) : obj_size, align);
+
+    // 페이지 하나에 슬롯이 최소 8개는 들어가야 의미가 있음
+    if (obj_size == 0 || slot_size > POOL_PAGESIZE / 8) {
+        return NULL;
+    }
+    if ((pool = heap_alloc(0, sizeof(mm_pool_t))) == NULL) {
+        return NULL;
+    }
+    if (pthread_key_create(&pool->mag_key, magazine_destructor) != 0) {
+        heap_free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pool->slot_size = slot_size;
+    pool->slot_offset = ROUND_UP(sizeof(pool_page_t), align);
+    pool->partial = NULL;
+    pool->full = NULL;
+    return pool;
+}
+
+void *mm_pool_alloc(mm_pool_t *pool) {
+    pool_magazine_t *mag = get_magazine(pool);
+
+    if (mag == NULL) {
+        return NULL;
+    }
+    // 빠른 경로: 매거진에서 꺼냄 (락 없음)
+    if (mag->count == 0 && refill(pool, mag) == 0) {
+        return NULL;
+    }
+    return mag->slots[--mag->count];
+}
+
+void mm_pool_free(mm_pool_t *pool, void *obj) {
+    pool_magazine_t *mag;
+
+    if (obj == NULL) {
+        return;
+    }
+    if ((mag = get_magazine(pool)) == NULL) {
+        give_back(pool, &obj, 1);
+        return;
+    }
+    // 매거진이 차면 절반을 페이지로 돌려보냄
+    if (mag->count == POOL_MAGAZINE) {
+        flush(pool, mag, POOL_MAGAZINE / 2);
+    }
+    mag->slots[mag->count++] = obj;
+}
+
+void mm_pool_flush(mm_pool_t *pool) {
+    pool_magazine_t *mag = pthread_getspecific(pool->mag_key);
+
+    if (mag != NULL) {
+        flush(pool, mag, mag->count);
+    }
+}
+
+void mm_pool_destroy(mm_pool_t *pool) {
+    pool_magazine_t *mag = pthread_getspecific(pool->mag_key);
+    pool_page_t *pg;
+
+    // 호출 스레드의 매거진만 회수 가능 (다른 스레드 것은 이미 끝났어야 함)
+    if (mag != NULL) {
+        pthread_setspecific(pool->mag_key, NULL);
+        heap_free(mag);
+    }
+    pthread_key_delete(pool->mag_key);
+
+    while ((pg = pool->partial) != NULL) {
+        pool->partial = pg->next;
+        heap_free(pg);
+    }
+    while ((pg = pool->full) != NULL) {
+        pool->full = pg->next;
+        heap_free(pg);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    heap_free(pool);
+}
+
+/**
+ * @brief 캐시 라인 클래스 풀들을 만듭니다. 페이지는 첫 할당 때 받으므로 싸다.
+ */
+static void line_pools_init(void) {
+    int i;
+
+    for (i = 0; i < NUM_LINE_CLASSES; i++) {
+        line_pools[i] = mm_pool_create_aligned((i + 1) * POOL_CACHELINE, POOL_CACHELINE);
+    }
+}
+
+/**
+ * @brief size에 맞는 캐시 라인 클래스 풀
+ */
+static mm_pool_t *line_pool(size_t size) {
+    pthread_once(&line_once, line_pools_init);
+    return line_pools[size ? (size - 1) / POOL_CACHELINE : 0];
+}
+
+void *mm_malloc_cacheline(size_t size) {
+    mm_pool_t *pool;
+
+    // 큰 객체는 힙에서 직접: 라인 배수로 올려서 뒤 블록과 라인을 나누지 않게
+    if (size > POOL_LINE_MAX) {
+        return heap_alloc(POOL_CACHELINE, ROUND_UP(size, POOL_CACHELINE));
+    }
+    if ((pool = line_pool(size)) == NULL) {
+        return NULL;
+    }
+    return mm_pool_alloc(pool);
+}
+
+void mm_free_cacheline(void *p, size_t size) {
+    if (p == NULL) {
+        return;
+    }
+    if (size > POOL_LINE_MAX) {
+        heap_free(p);
+        return;
+    }
+    mm_pool_free(line_pool(size), p);
+}
@@ -0,0 +1,105 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h> // for size_t
+#include <pthread.h>
+
+/*
+ * 고정 크기 객체 풀
+ * 트리 노드처럼 크기가 같은 객체를 대량으로 할당/해제할 때 씁니다.
+ * mm_memalign으로 POOL_PAGESIZE 정렬 페이지를 받아 슬롯으로 나누므로
+ * 슬롯에는 헤더가 없고, 슬롯 주소만으로 자기 페이지를 찾습니다.
+ * 스레드마다 매거진(슬롯 캐시)을 두어 할당/해제의 빠른 경로에는
+ * 락이 없습니다. 페이지를 오가는 느린 경로만 락을 잡습니다.
+ */
+#define POOL_PAGESIZE   (1<<12)     // 페이지 크기 (정렬 단위이기도 함)
+#define POOL_MAGAZINE   32          // 스레드별 매거진 슬롯 수
+#define POOL_CACHELINE  64          // 캐시 라인 크기
+#define POOL_LINE_MAX   (POOL_PAGESIZE/8)   // 캐시 라인 클래스의 최대 크기
+
+typedef struct pool_page {
+    struct pool_page *prev;     // 같은 리스트(partial 또는 full)의 이전 페이지
+    struct pool_page *next;     // 다음 페이지
+    void *free;                 // 반환된 슬롯 스택 (슬롯 안에 next 저장)
+    char *carve;                // 아직 한 번도 안 쓴 첫 슬롯
+    char *limit;                // 슬롯 영역의 끝
+    int used;                   // 페이지 밖으로 나간 슬롯 수 (매거진 포함)
+    int on_partial;             // partial 리스트에 있으면 1
+} pool_page_t;
+
+typedef struct mm_pool {
+    size_t slot_size;           // 정렬된 슬롯 크기
+    size_t slot_offset;         // 페이지 시작에서 첫 슬롯까지 (정렬 단위로 올림)
+    pool_page_t *partial;       // 남은 슬롯이 있는 페이지들
+    pool_page_t *full;          // 슬롯을 전부 내준 페이지들
+    pthread_mutex_t lock;       // partial/full 리스트 보호
+    pthread_key_t mag_key;      // 스레드별 매거진
+} mm_pool_t;
+
+typedef struct pool_magazine {
+    mm_pool_t *pool;            // 스레드 종료 시 돌려줄 풀
+    int count;                  // 캐시된 슬롯 수
+    void *slots[POOL_MAGAZINE];
+} pool_magazine_t;
+
+
+/*
+ * Public API
+ */
+
+/**
+ * @brief obj_size 바이트 객체용 풀을 만듭니다.
+ * @return 새 풀. obj_size가 너무 크거나 메모리가 없으면 NULL.
+ */
+mm_pool_t *mm_pool_create(size_t obj_size);
+
+/**
+ * @brief 모든 슬롯이 align 바이트 경계에서 시작하고 크기도 align의
+ * 배수인 풀을 만듭니다. align은 ALIGNMENT 이상의 2의 거듭제곱.
+ * @return 새 풀. 인자가 잘못됐거나 메모리가 없으면 NULL.
+ */
+mm_pool_t *mm_pool_create_aligned(size_t obj_size, size_t align);
+
+/**
+ * @brief 객체 하나를 할당합니다. 매거진에 슬롯이 있으면 락 없이 끝납니다.
+ */
+void *mm_pool_alloc(mm_pool_t *pool);
+
+/**
+ * @brief 객체 하나를 반환합니다. 매거진이 차면 절반을 페이지로 돌려주고,
+ * 완전히 빈 페이지는 mm_free로 힙에 돌려줍니다.
+ */
+void mm_pool_free(mm_pool_t *pool, void *obj);
+
+/**
+ * @brief 호출한 스레드의 매거진을 비워 슬롯을 페이지로 돌려줍니다.
+ */
+void mm_pool_flush(mm_pool_t *pool);
+
+/**
+ * @brief 풀과 모든 페이지를 돌려줍니다.
+ * 다른 스레드는 이미 풀 사용을 끝냈어야 합니다.
+ */
+void mm_pool_destroy(mm_pool_t *pool);
+
+/*
+ * 캐시 라인 클래스
+ * 스레드마다 따로 쓰는 카운터처럼 다른 객체와 캐시 라인을 나누면 안 되는
+ * 객체용입니다. POOL_LINE_MAX 이하는 POOL_CACHELINE 배수 크기 클래스별
+ * 정렬 풀에서, 그보다 크면 mm_memalign에서 받습니다. 풀 슬롯에는 헤더가
+ * 없으므로 라인마다 헤더/푸터를 낭비하지 않습니다.
+ * 클래스 풀은 프로세스 내내 살아 있으므로, 처음 쓴 뒤에는 mm_init으로
+ * 힙을 다시 만들면 안 됩니다.
+ */
+
+/**
+ * @brief 캐시 라인 경계에서 시작하고 라인 단위로 채운 블록을 할당합니다.
+ */
+void *mm_malloc_cacheline(size_t size);
+
+/**
+ * @brief mm_malloc_cacheline 블록을 반환합니다. size는 할당 때와 같아야 합니다.
+ */
+void mm_free_cacheline(void *p, size_t size);
+
+#endif // POOL_H
@@ -0,0 +1,236 @@
+/*
+ * poolbench.c - Compare mm_pool against mm_malloc/mm_free for the
+ *     node-sized objects (16-48 bytes) that tree and list code allocates.
+ *
+ * Each round allocates n objects and frees them in shuffled order.
+ * The multi-threaded rows run the same rounds from t threads at once;
+ * mm_malloc is not thread-safe, so its row wraps every call in a mutex,
+ * which is what a caller sharing the heap would have to do.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "mm.h"
+#include "memlib.h"
+#include "pool.h"
+#include "ftimer.h"
+
+#define MAXTHREADS 64
+#define ROUNDS      4   /* rounds timed by ftimer_gettod for one thread */
+#define MT_ROUNDS  20   /* rounds each thread runs in the threaded test */
+
+/* Parameters for one benchmark run */
+typedef struct {
+    size_t size;        /* object size in bytes */
+    int n;              /* objects per round */
+    int *perm;          /* shuffled free order */
+    void **objs;        /* this thread's object array */
+    mm_pool_t *pool;    /* pool under test (pool rows only) */
+} bench_t;
+
+static pthread_mutex_t mm_lock = PTHREAD_MUTEX_INITIALIZER;
+static int use_lock = 0;  /* wrap mm_malloc/mm_free in mm_lock */
+
+static void app_error(char *msg)
+{
+    printf("%s\n", msg);
+    exit(1);
+}
+
+/*
+ * mm_round - one round of n mm_malloc calls and n shuffled mm_free calls
+ */
+static void mm_round(void *argp)
+{
+    bench_t *b = argp;
+    int i;
+
+    for (i = 0; i < b->n; i++) {
+	if (use_lock)
+	    pthread_mutex_lock(&mm_lock);
+	b->objs[i] = mm_malloc(b->size);
+	if (use_lock)
+	    pthread_mutex_unlock(&mm_lock);
+	if (b->objs[i] == NULL)
+	    app_error("mm_malloc failed in mm_round");
+    }
+    for (i = 0; i < b->n; i++) {
+	if (use_lock)
+	    pthread_mutex_lock(&mm_lock);
+	mm_free(b->objs[b->perm[i]]);
+	if (use_lock)
+	    pthread_mutex_unlock(&mm_lock);
+    }
+}
+
+/*
+ * pool_round - the same round through mm_pool_alloc/mm_pool_free
+ */
+static void pool_round(void *argp)
+{
+    bench_t *b = argp;
+    int i;
+
+    for (i = 0; i < b->n; i++)
+	if ((b->objs[i] = mm_pool_alloc(b->pool)) == NULL)
+	    app_error("mm_pool_alloc failed in pool_round");
+    for (i = 0; i < b->n; i++)
+	mm_pool_free(b->pool, b->objs[b->perm[i]]);
+}
+
+static void *mm_thread(void *argp)
+{
+    int r;
+
+    mm_stats_thread();
+    for (r = 0; r < MT_ROUNDS; r++)
+	mm_round(argp);
+    return NULL;
+}
+
+static void *pool_thread(void *argp)
+{
+    int r;
+
+    for (r = 0; r < MT_ROUNDS; r++)
+	pool_round(argp);
+    mm_pool_flush(((bench_t *)argp)->pool);
+    return NULL;
+}
+
+/*
+ * run_threads - time nthreads threads running f, return elapsed seconds
+ */
+static double run_threads(void *(*f)(void *), bench_t *b, int nthreads)
+{
+    pthread_t tid[MAXTHREADS];
+    struct timeval stv, etv;
+    int i;
+
+    gettimeofday(&stv, NULL);
+    for (i = 0; i < nthreads; i++)
+	pthread_create(&tid[i], NULL, f, &b[i]);
+    for (i = 0; i < nthreads; i++)
+	pthread_join(tid[i], NULL);
+    gettimeofday(&etv, NULL);
+    return (etv.tv_sec - stv.tv_sec) + 1E-6*(etv.tv_usec - stv.tv_usec);
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: poolbench [-h] [-n <objs>] [-t <threads>]\n");
+    fprintf(stderr, "Options\n");
+    fprintf(stderr, "\t-h         Print this message.\n");
+    fprintf(stderr, "\t-n <objs>  Objects per round per thread (default 20000).\n");
+    fprintf(stderr, "\t-t <n>     Threads for the threaded rows (default 4).\n");
+}
+
+int main(int argc, char **argv)
+{
+    static const size_t sizes[] = {16, 24, 32, 40, 48};
+    bench_t b[MAXTHREADS];
+    int n = 20000;
+    int nthreads = 4;
+    int i, j, s;
+    char c;
+    double ops, mm_secs, pool_secs;
+
+    while ((c = getopt(argc, argv, "n:t:h")) != EOF) {
+	switch (c) {
+	case 'n':
+	    n = atoi(optarg);
+	    break;
+	case 't':
+	    nthreads = atoi(optarg);
+	    break;
+	case 'h':
+	    usage();
+	    exit(0);
+	default:
+	    usage();
+	    exit(1);
+	}
+    }
+    if (n <= 0 || nthreads <= 0 || nthreads > MAXTHREADS) {
+	usage();
+	exit(1);
+    }
+
+    /* Per-thread object arrays and free orders (from libc, not the heap) */
+    for (i = 0; i < nthreads; i++) {
+	b[i].n = n;
+	b[i].objs = malloc(n * sizeof(void *));
+	b[i].perm = malloc(n * sizeof(int));
+	if (b[i].objs == NULL || b[i].perm == NULL)
+	    app_error("malloc failed in main");
+	srand(15213 + i);
+	for (j = 0; j < n; j++)
+	    b[i].perm[j] = j;
+	for (j = n - 1; j > 0; j--) {
+	    int k = rand() % (j + 1);
+	    int tmp = b[i].perm[j];
+	    b[i].perm[j] = b[i].perm[k];
+	    b[i].perm[k] = tmp;
+	}
+    }
+
+    mem_init();
+
+    /* Single thread: ftimer_gettod averages ROUNDS rounds */
+    printf("1 thread, %d objects per round\n", n);
+    printf("%5s%12s%12s%9s\n", "size", "mm Kops", "pool Kops", "speedup");
+    for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+	b[0].size = sizes[s];
+	ops = 2.0 * n;
+
+	mem_reset_brk();
+	if (mm_init() < 0)
+	    app_error("mm_init failed");
+	mm_secs = ftimer_gettod(mm_round, &b[0], ROUNDS);
+
+	mem_reset_brk();
+	if (mm_init() < 0)
+	    app_error("mm_init failed");
+	if ((b[0].pool = mm_pool_create(sizes[s])) == NULL)
+	    app_error("mm_pool_create failed");
+	pool_secs = ftimer_gettod(pool_round, &b[0], ROUNDS);
+	mm_pool_destroy(b[0].pool);
+
+	printf("%5d%12.0f%12.0f%8.1fx\n", (int)sizes[s],
+	       ops / 1e3 / mm_secs, ops / 1e3 / pool_secs, mm_secs / pool_secs);
+    }
+
+    /* Threaded: locked mm_malloc vs a shared pool */
+    printf("\n%d threads, %d objects per round per thread\n", nthreads, n);
+    printf("%5s%12s%12s%9s\n", "size", "mm Kops", "pool Kops", "speedup");
+    for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+	ops = 2.0 * n * MT_ROUNDS * nthreads;
+
+	mem_reset_brk();
+	if (mm_init() < 0)
+	    app_error("mm_init failed");
+	for (i = 0; i < nthreads; i++)
+	    b[i].size = sizes[s];
+	use_lock = 1;
+	mm_secs = run_threads(mm_thread, b, nthreads);
+	use_lock = 0;
+
+	mem_reset_brk();
+	if (mm_init() < 0)
+	    app_error("mm_init failed");
+	if ((b[0].pool = mm_pool_create(sizes[s])) == NULL)
+	    app_error("mm_pool_create failed");
+	for (i = 1; i < nthreads; i++)
+	    b[i].pool = b[0].pool;
+	pool_secs = run_threads(pool_thread, b, nthreads);
+	mm_pool_destroy(b[0].pool);
+
+	printf("%5d%12.0f%12.0f%8.1fx\n", (int)sizes[s],
+	       ops / 1e3 / mm_secs, ops / 1e3 / pool_secs, mm_secs / pool_secs);
+    }
+
+    exit(0);
+}
@@ -0,0 +1,128 @@
+#include "region.h"
+#include "mm.h"
+#include "config.h"
+
+/* 기본 청크 크기 */
+#define REGION_CHUNKSIZE (1<<12)
+
+/* ALIGNMENT 배수로 올림 */
+#define REGION_ALIGN(size) (((size) + (ALIGNMENT-1)) & ~(size_t)(ALIGNMENT-1))
+
+/* 청크 헤더 뒤, 실제 객체가 놓이는 영역의 시작 */
+#define CHUNK_DATA(c) ((char *)(c) + REGION_ALIGN(sizeof(region_chunk_t)))
+
+/*
+ * ----------------------------------------------------------------- 
+ * 내부 헬퍼 함수 (Static)
+ * -----------------------------------------------------------------
+ */
+
+/**
+ * @brief 데이터 영역이 size 바이트인 청크를 mm_malloc으로 받아옵니다.
+ */
+static region_chunk_t *new_chunk(size_t size) {
+    region_chunk_t *c = mm_malloc(REGION_ALIGN(sizeof(region_chunk_t)) + size);
+
+    if (c == NULL) {
+        return NULL;
+    }
+    c->next = NULL;
+    c->size = size;
+    return c;
+}
+
+/**
+ * @brief bump 포인터가 c의 처음을 가리키도록 합니다.
+ */
+static void use_chunk(mm_region_t *r, region_chunk_t *c) {
+    r->cur = c;
+    r->bump = CHUNK_DATA(c);
+    r->limit = r->bump + c->size;
+}
+
+/**
+ * @brief 현재 청크에 size 바이트가 없을 때의 느린 경로
+ * reset 전에 쓰던 다음 청크가 충분하면 재사용하고,
+ * 아니면 새 청크를 cur 바로 뒤에 끼워 넣습니다.
+ */
+static int refill(mm_region_t *r, size_t size) {
+    region_chunk_t *next = r->cur->next;
+
+    if (next == NULL || next->size < size) {
+        next = new_chunk(size > r->chunk_size ? size : r->chunk_size);
+        if (next == NULL) {
+            return 0;
+        }
+        next->next = r->cur->next;
+        r->cur->next = next;
+    }
+    use_chunk(r, next);
+    return 1;
+}
+
+
+/*
+ * ----------------------------------------------------------------- 
+ * Public API 함수 구현
+ * -----------------------------------------------------------------
+ */
+
+mm_region_t *mm_region_create(size_t chunk_size) {
+    mm_region_t *r;
+
+    if (chunk_size == 0) {
+        chunk_size = REGION_CHUNKSIZE;
+    }
+    if ((r = mm_malloc(sizeof(mm_region_t))) == NULL) {
+        return NULL;
+    }
+    r->chunk_size = REGION_ALIGN(chunk_size);
+    if ((r->head = new_chunk(r->chunk_size)) == NULL) {
+        mm_free(r);
+        return NULL;
+    }
+    use_chunk(r, r->head);
+    return r;
+}
+
+void *mm_region_alloc(mm_region_t *r, size_t size) {
+    char *p;
+
+    size = REGION_ALIGN(size);
+
+    // 빠른 경로: 현재 청크에서 포인터만 민다
+    if (size > (size_t)(r->limit - r->bump) && !refill(r, size)) {
+        return NULL;
+    }
+    p = r->bump;
+    r->bump += size;
+    return p;
+}
+
+void mm_region_reset(mm_region_t *r) {
+    region_chunk_t *c = r->head;
+
+    // 큰 요청용 전용 청크만 떼어 내고, 기본 청크는 남긴다
+    while (c->next != NULL) {
+        region_chunk_t *next = c->next;
+
+        if (next->size > r->chunk_size) {
+            c->next = next->next;
+            mm_free(next);
+        } else {
+            c = next;
+        }
+    }
+    use_chunk(r, r->head);
+}
+
+void mm_region_destroy(mm_region_t *r) {
+    region_chunk_t *c = r->head;
+
+    while (c != NULL) {
+        region_chunk_t *next = c->next;
+        mm_free(c);
+        c = next;
+    }
+    mm_free(r);
+}
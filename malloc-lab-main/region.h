@@ -0,0 +1,56 @@
+#ifndef REGION_H
+#define REGION_H
+
+#include <stddef.h> // for size_t
+
+/*
+ * 리전(bump-pointer) 할당기
+ * 요청 단위로 한꺼번에 버려지는 객체들을 위한 할당기입니다.
+ * mm_malloc에서 큰 청크를 받아 포인터를 밀어가며 나눠주므로
+ * 객체마다 헤더/푸터가 없고, 개별 free도 없습니다.
+ */
+typedef struct region_chunk {
+    struct region_chunk *next;  // 다음 청크
+    size_t size;                // 청크 헤더 뒤에 쓸 수 있는 바이트 수
+} region_chunk_t;
+
+typedef struct mm_region {
+    region_chunk_t *head;       // 첫 청크 (reset 후에도 유지)
+    region_chunk_t *cur;        // 지금 포인터를 밀고 있는 청크
+    char *bump;                 // cur 안의 다음 할당 위치
+    char *limit;                // cur의 끝
+    size_t chunk_size;          // 기본 청크 크기
+} mm_region_t;
+
+
+/*
+ * Public API
+ */
+
+/**
+ * @brief 리전을 만들고 첫 청크를 mm_malloc으로 받아옵니다.
+ * @param chunk_size 기본 청크 크기 (0이면 REGION_CHUNKSIZE)
+ * @return 새 리전. 메모리가 없으면 NULL.
+ */
+mm_region_t *mm_region_create(size_t chunk_size);
+
+/**
+ * @brief 리전에서 size 바이트를 포인터 증가로 할당합니다.
+ * chunk_size보다 큰 요청은 전용 청크를 따로 받습니다.
+ * @return ALIGNMENT 정렬된 포인터. 메모리가 없으면 NULL.
+ */
+void *mm_region_alloc(mm_region_t *r, size_t size);
+
+/**
+ * @brief 리전의 모든 객체를 한 번에 버립니다.
+ * 기본 크기 청크는 다음 요청을 위해 남겨 두고, 전용 청크만 돌려줍니다.
+ * (청크마다 O(1))
+ */
+void mm_region_reset(mm_region_t *r);
+
+/**
+ * @brief 리전과 모든 청크를 mm_free로 돌려줍니다.
+ */
+void mm_region_destroy(mm_region_t *r);
+
+#endif // REGION_H
@@ -0,0 +1,151 @@
+/*
+ * sharebench.c - Show the false sharing that mm_malloc_cacheline avoids.
+ *
+ * Each of t threads increments its own counter n times. The counters are
+ * allocated back to back from the main thread, first with mm_malloc and
+ * then with mm_malloc_cacheline. With mm_malloc neighbouring counters
+ * land 16 bytes apart, so several threads write the same cache line and
+ * the line bounces between cores; with mm_malloc_cacheline each counter
+ * owns its line. The effect needs t > 1 and as many cores.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "mm.h"
+#include "memlib.h"
+#include "pool.h"
+
+#define MAXTHREADS 64
+#define LINE(p) ((size_t)(p) / POOL_CACHELINE)
+
+/* Parameters for one counting thread */
+typedef struct {
+    volatile long *counter;  /* the thread's own counter */
+    long n;                  /* increments to do */
+} bench_t;
+
+static void app_error(char *msg)
+{
+    printf("%s\n", msg);
+    exit(1);
+}
+
+static void *count_thread(void *argp)
+{
+    bench_t *b = argp;
+    long i;
+
+    for (i = 0; i < b->n; i++)
+	(*b->counter)++;
+    return NULL;
+}
+
+/*
+ * run_threads - time nthreads threads counting, return elapsed seconds
+ */
+static double run_threads(bench_t *b, int nthreads)
+{
+    pthread_t tid[MAXTHREADS];
+    struct timeval stv, etv;
+    int i;
+
+    gettimeofday(&stv, NULL);
+    for (i = 0; i < nthreads; i++)
+	pthread_create(&tid[i], NULL, count_thread, &b[i]);
+    for (i = 0; i < nthreads; i++)
+	pthread_join(tid[i], NULL);
+    gettimeofday(&etv, NULL);
+    return (etv.tv_sec - stv.tv_sec) + 1E-6*(etv.tv_usec - stv.tv_usec);
+}
+
+/*
+ * shared_lines - number of counters that share a cache line with the
+ *     counter allocated just before them
+ */
+static int shared_lines(bench_t *b, int nthreads)
+{
+    int i, shared = 0;
+
+    for (i = 1; i < nthreads; i++)
+	if (LINE(b[i].counter) == LINE(b[i-1].counter))
+	    shared++;
+    return shared;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: sharebench [-h] [-n <incs>] [-t <threads>]\n");
+    fprintf(stderr, "Options\n");
+    fprintf(stderr, "\t-h         Print this message.\n");
+    fprintf(stderr, "\t-n <incs>  Increments per thread (default 50000000).\n");
+    fprintf(stderr, "\t-t <n>     Counting threads (default 4).\n");
+}
+
+int main(int argc, char **argv)
+{
+    bench_t b[MAXTHREADS];
+    long n = 50000000;
+    int nthreads = 4;
+    int i;
+    char c;
+    double ops, mm_secs, line_secs;
+
+    while ((c = getopt(argc, argv, "n:t:h")) != EOF) {
+	switch (c) {
+	case 'n':
+	    n = atol(optarg);
+	    break;
+	case 't':
+	    nthreads = atoi(optarg);
+	    break;
+	case 'h':
+	    usage();
+	    exit(0);
+	default:
+	    usage();
+	    exit(1);
+	}
+    }
+    if (n <= 0 || nthreads <= 0 || nthreads > MAXTHREADS) {
+	usage();
+	exit(1);
+    }
+
+    mem_init();
+    if (mm_init() < 0)
+	app_error("mm_init failed");
+    ops = (double)n * nthreads;
+    printf("%d threads, %ld increments each\n", nthreads, n);
+    printf("%-22s%8s%12s\n", "counters from", "shared", "Mincs/s");
+
+    /* Counters packed by mm_malloc */
+    for (i = 0; i < nthreads; i++) {
+	if ((b[i].counter = mm_malloc(sizeof(long))) == NULL)
+	    app_error("mm_malloc failed");
+	*b[i].counter = 0;
+	b[i].n = n;
+    }
+    mm_secs = run_threads(b, nthreads);
+    printf("%-22s%8d%12.0f\n", "mm_malloc", shared_lines(b, nthreads),
+	   ops / 1e6 / mm_secs);
+    for (i = 0; i < nthreads; i++)
+	mm_free((void *)b[i].counter);
+
+    /* One cache line per counter */
+    for (i = 0; i < nthreads; i++) {
+	if ((b[i].counter = mm_malloc_cacheline(sizeof(long))) == NULL)
+	    app_error("mm_malloc_cacheline failed");
+	*b[i].counter = 0;
+    }
+    line_secs = run_threads(b, nthreads);
+    printf("%-22s%8d%12.0f\n", "mm_malloc_cacheline", shared_lines(b, nthreads),
+	   ops / 1e6 / line_secs);
+    for (i = 0; i < nthreads; i++)
+	mm_free_cacheline((void *)b[i].counter, sizeof(long));
+
+    printf("speedup %.1fx\n", mm_secs / line_secs);
+    exit(0);
+}
@@ -0,0 +1,68 @@
+#!/usr/bin/perl
+#!/usr/local/bin/perl
+
+# Request-scoped pattern: each "request" allocates a burst of small
+# objects (and the odd large buffer or growing string), then frees
+# everything it allocated before the next request starts. This is the
+# pattern a region (bump-pointer) allocator is built for.
+
+$out_filename = "region.rep";
+$num_requests = 100;
+$min_objs = 50;
+$max_objs = 200;
+$min_size = 8;
+$max_size = 256;
+$large_size = 4096;
+
+srand(15213);
+
+# Open output file
+open OUTFILE, ">$out_filename" or die "Cannot create $out_filename\n";
+
+# Generate the requests first so the header counts are known
+@lines = ();
+$blk = 0;
+$suggested_heap_size = 0;
+for ($r = 0; $r < $num_requests; $r += 1) {
+    $num_objs = $min_objs + int(rand($max_objs - $min_objs + 1));
+    @live = ();
+    $bytes = 0;
+    for ($i = 0; $i < $num_objs; $i += 1) {
+	if (rand() < 0.02) {
+	    $size = $large_size + int(rand($large_size));
+	} else {
+	    $size = $min_size + int(rand($max_size - $min_size + 1));
+	}
+	push @lines, "a $blk $size";
+	$bytes += $size;
+	if (rand() < 0.05) {
+	    $size *= 2;
+	    push @lines, "r $blk $size";
+	    $bytes += $size;
+	}
+	push @live, $blk;
+	$blk += 1;
+    }
+    # free in a shuffled order, as request teardown would
+    for ($i = $#live; $i > 0; $i -= 1) {
+	$j = int(rand($i + 1));
+	@live[$i, $j] = @live[$j, $i];
+    }
+    foreach $id (@live) {
+	push @lines, "f $id";
+    }
+    $suggested_heap_size = $bytes if ($bytes > $suggested_heap_size);
+}
+
+$num_blocks = $blk;
+$num_ops = scalar(@lines);
+
+print OUTFILE "$suggested_heap_size\n";
+print OUTFILE "$num_blocks\n";
+print OUTFILE "$num_ops\n";
+print OUTFILE "1\n";
+foreach $line (@lines) {
+    print OUTFILE "$line\n";
+}
+
+close OUTFILE;
@@ -0,0 +1,96 @@
+#include "bptree.h"
+#include "rbtree.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// 키 수를 10배씩 늘려 가며 rbtree와 bptree의 insert/find/to_array/erase를 비교.
+// find는 작은 트리에서도 잴 만하도록 최소 100만 번, 결과는 연산당 ns.
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[]) {
+    size_t max_n = 10000000;
+    unsigned int seed = 1;
+    size_t sink = 0;
+    int c;
+
+    while ((c = getopt(argc, argv, "m:s:h")) != -1) {
+        switch (c) {
+        case 'm':
+            max_n = (size_t)strtod(optarg, NULL);
+            break;
+        case 's':
+            seed = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-m max keys, e.g. 1e8] [-s seed]\n", argv[0]);
+            exit(c == 'h' ? 0 : 1);
+        }
+    }
+
+    key_t *keys = malloc(max_n * sizeof(key_t));
+    key_t *out = malloc(max_n * sizeof(key_t));
+    if (!keys || !out) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    srand(seed);
+    for (size_t i = 0; i < max_n; i++)
+        keys[i] = rand();
+
+    printf("%10s %7s %9s %9s %9s %9s  (ns/op)\n",
+           "keys", "tree", "insert", "find", "to_array", "erase");
+    for (size_t n = 1000; n <= max_n; n *= 10) {
+        size_t lookups = n < 1000000 ? 1000000 : n;
+        double t0, t1, t2, t3, t4;
+
+        rbtree *rt = new_rbtree();
+        t0 = now();
+        for (size_t i = 0; i < n; i++)
+            rbtree_insert(rt, keys[i]);
+        t1 = now();
+        for (size_t i = 0; i < lookups; i++)
+            sink += rbtree_find(rt, keys[(i * 7919) % n])->key;
+        t2 = now();
+        sink += rbtree_to_array(rt, out, n);
+        t3 = now();
+        for (size_t i = 0; i < n; i++)
+            rbtree_erase(rt, rbtree_find(rt, keys[i]));
+        t4 = now();
+        delete_rbtree(rt);
+        printf("%10zu %7s %9.1f %9.1f %9.2f %9.1f\n", n, "rbtree",
+               (t1 - t0) * 1e9 / n, (t2 - t1) * 1e9 / lookups,
+               (t3 - t2) * 1e9 / n, (t4 - t3) * 1e9 / n);
+
+        bptree *bt = new_bptree();
+        t0 = now();
+        for (size_t i = 0; i < n; i++)
+            bptree_insert(bt, keys[i]);
+        t1 = now();
+        for (size_t i = 0; i < lookups; i++)
+            sink += *bptree_find(bt, keys[(i * 7919) % n]);
+        t2 = now();
+        sink += bptree_to_array(bt, out, n);
+        t3 = now();
+        for (size_t i = 0; i < n; i++)
+            bptree_erase(bt, keys[i]);
+        t4 = now();
+        delete_bptree(bt);
+        printf("%10zu %7s %9.1f %9.1f %9.2f %9.1f\n", n, "bptree",
+               (t1 - t0) * 1e9 / n, (t2 - t1) * 1e9 / lookups,
+               (t3 - t2) * 1e9 / n, (t4 - t3) * 1e9 / n);
+        fflush(stdout);
+    }
+
+    if (sink == 1)
+        printf("\n");
+    free(keys);
+    free(out);
+    return 0;
+}
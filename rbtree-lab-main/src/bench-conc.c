@@ -0,0 +1,166 @@
+#include "rbtree.h"
+#include "rbtree_conc.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// 읽기 스레드 수를 1, 2, 4, ...로 늘려 가며 find 처리량을 잰다.
+// 쓰기 스레드 하나가 같은 시간 동안 insert/erase를 -w 간격(us)으로 계속함.
+// seqlock: rbtree_conc (락 없는 읽기), rwlock/mutex: rbtree를 락으로 감싼 것 (비교용)
+
+enum { MODE_SEQLOCK, MODE_RWLOCK, MODE_MUTEX };
+static const char *mode_names[] = {"seqlock", "rwlock", "mutex"};
+
+static int mode;
+static rbtree_conc *conc;
+static rbtree *plain;
+static pthread_rwlock_t rwlock;
+static pthread_mutex_t mutex;
+static size_t n;
+static int write_gap_us = 10;
+static volatile int stop;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int find(key_t key) {
+    int found;
+    switch (mode) {
+    case MODE_SEQLOCK:
+        return rbtree_conc_find(conc, key);
+    case MODE_RWLOCK:
+        pthread_rwlock_rdlock(&rwlock);
+        found = rbtree_find(plain, key) != NULL;
+        pthread_rwlock_unlock(&rwlock);
+        return found;
+    default:
+        pthread_mutex_lock(&mutex);
+        found = rbtree_find(plain, key) != NULL;
+        pthread_mutex_unlock(&mutex);
+        return found;
+    }
+}
+
+// 키는 짝수만 미리 넣어 두고, 쓰기는 홀수 키를 넣었다 지움
+static void churn(key_t key) {
+    if (mode == MODE_SEQLOCK) {
+        rbtree_conc_insert(conc, key);
+        rbtree_conc_erase(conc, key);
+        return;
+    }
+    if (mode == MODE_RWLOCK)
+        pthread_rwlock_wrlock(&rwlock);
+    else
+        pthread_mutex_lock(&mutex);
+    rbtree_erase(plain, rbtree_insert(plain, key));
+    if (mode == MODE_RWLOCK)
+        pthread_rwlock_unlock(&rwlock);
+    else
+        pthread_mutex_unlock(&mutex);
+}
+
+static void *reader(void *arg) {
+    size_t *count = arg, i = 0, hits = 0;
+    unsigned int seed = (unsigned int)(size_t)count;
+    while (!stop) {
+        for (int j = 0; j < 256; j++)
+            hits += find((key_t)(rand_r(&seed) % n) * 2);
+        i += 256;
+    }
+    *count = i + (hits == 1);
+    return NULL;
+}
+
+static void *writer(void *arg) {
+    size_t *count = arg, i = 0;
+    unsigned int seed = 7;
+    while (!stop) {
+        churn((key_t)(rand_r(&seed) % n) * 2 + 1);
+        i++;
+        if (write_gap_us > 0)
+            usleep(write_gap_us);
+    }
+    *count = i;
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    int max_readers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    double secs = 0.5;
+    int c;
+
+    n = 1000000;
+    while ((c = getopt(argc, argv, "n:t:d:w:h")) != -1) {
+        switch (c) {
+        case 'n':
+            n = (size_t)strtod(optarg, NULL);
+            break;
+        case 't':
+            max_readers = atoi(optarg);
+            break;
+        case 'd':
+            secs = strtod(optarg, NULL);
+            break;
+        case 'w':
+            write_gap_us = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-n keys] [-t max readers] [-d seconds per run] "
+                    "[-w us between writes, 0 = nonstop]\n", argv[0]);
+            exit(c == 'h' ? 0 : 1);
+        }
+    }
+    if (max_readers < 1)
+        max_readers = 1;
+
+    conc = new_rbtree_conc();
+    plain = new_rbtree();
+    pthread_rwlock_init(&rwlock, NULL);
+    pthread_mutex_init(&mutex, NULL);
+    if (!conc || !plain) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < n; i++) {
+        rbtree_conc_insert(conc, (key_t)i * 2);
+        rbtree_insert(plain, (key_t)i * 2);
+    }
+
+    printf("%zu keys, %ld cpus online, 1 writer every %d us\n", n,
+           sysconf(_SC_NPROCESSORS_ONLN), write_gap_us);
+    printf("%-8s %7s %14s %12s\n", "mode", "readers", "reads Mops/s", "writes/s");
+    pthread_t *threads = malloc((max_readers + 1) * sizeof(pthread_t));
+    size_t *counts = malloc((max_readers + 1) * sizeof(size_t));
+    for (mode = MODE_SEQLOCK; mode <= MODE_MUTEX; mode++) {
+        for (int readers = 1; readers <= max_readers; readers *= 2) {
+            stop = 0;
+            for (int i = 0; i < readers; i++)
+                pthread_create(&threads[i], NULL, reader, &counts[i]);
+            pthread_create(&threads[readers], NULL, writer, &counts[readers]);
+            double t0 = now();
+            usleep((useconds_t)(secs * 1e6));
+            stop = 1;
+            size_t reads = 0;
+            for (int i = 0; i <= readers; i++)
+                pthread_join(threads[i], NULL);
+            double elapsed = now() - t0;
+            for (int i = 0; i < readers; i++)
+                reads += counts[i];
+            printf("%-8s %7d %14.2f %12.0f\n", mode_names[mode], readers,
+                   reads / elapsed / 1e6, counts[readers] / elapsed);
+            fflush(stdout);
+        }
+    }
+
+    free(counts);
+    free(threads);
+    delete_rbtree(plain);
+    delete_rbtree_conc(conc);
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include "rbtree.h"
+#include "rbtree_gen.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// rbtree_gen.h로 찍어낸 트리와 rbtree.c(int 키)의 insert/find 처리량 비교.
+// int 키끼리는 같은 속도, 64비트/문자열 키도 함수 포인터 없이 도는지 봐요.
+// int-c는 COMPACT(32바이트 노드) 트리. -n을 크게 주면 LLC보다 큰 트리에서
+// 노드 크기가 find에 얼마나 영향을 주는지 볼 수 있어요.
+
+RBTREE_DEFINE(imap, int, int, RBTREE_CMP_NUM)
+RBTREE_DEFINE(u64map, uint64_t, uint64_t, RBTREE_CMP_NUM)
+RBTREE_DEFINE(smap, const char *, size_t, RBTREE_CMP_STR)
+RBTREE_DEFINE_COMPACT(cmap, int, int, RBTREE_CMP_NUM)
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void report(const char *tree, const char *phase, size_t ops, double secs) {
+    printf("%-8s %-7s %10zu ops %9.3f ms %8.2f Mops/s\n",
+           tree, phase, ops, secs * 1e3, ops / secs / 1e6);
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = 1000000;
+    unsigned int seed = 1;
+    size_t sink = 0;
+    int c;
+
+    while ((c = getopt(argc, argv, "n:s:h")) != -1) {
+        switch (c) {
+        case 'n':
+            n = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            seed = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-n keys] [-s seed]\n", argv[0]);
+            exit(c == 'h' ? 0 : 1);
+        }
+    }
+
+    int *keys = malloc(n * sizeof(int));
+    char (*strs)[12] = malloc(n * sizeof(*strs));
+    if (!keys || !strs) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    srand(seed);
+    for (size_t i = 0; i < n; i++) {
+        keys[i] = rand();
+        snprintf(strs[i], sizeof(strs[i]), "k%08x", (unsigned)keys[i]);
+    }
+
+    printf("%zu keys; node bytes: rbtree %zu, int %zu, int-c %zu, u64 %zu, string %zu\n",
+           n, sizeof(node_t), sizeof(imap_node), sizeof(cmap_node),
+           sizeof(u64map_node), sizeof(smap_node));
+
+    double t0 = now();
+    rbtree *rt = new_rbtree();
+    for (size_t i = 0; i < n; i++)
+        rbtree_insert(rt, keys[i]);
+    double t1 = now();
+    for (size_t i = 0; i < n; i++)
+        sink += rbtree_find(rt, keys[i])->key;
+    double t2 = now();
+    delete_rbtree(rt);
+    report("rbtree", "insert", n, t1 - t0);
+    report("rbtree", "find", n, t2 - t1);
+
+    t0 = now();
+    imap_tree *it = imap_new();
+    for (size_t i = 0; i < n; i++)
+        imap_insert(it, keys[i], (int)i);
+    t1 = now();
+    for (size_t i = 0; i < n; i++)
+        sink += imap_find(it, keys[i])->value;
+    t2 = now();
+    imap_delete(it);
+    report("int", "insert", n, t1 - t0);
+    report("int", "find", n, t2 - t1);
+
+    t0 = now();
+    cmap_tree *ct = cmap_new();
+    for (size_t i = 0; i < n; i++)
+        cmap_insert(ct, keys[i], (int)i);
+    t1 = now();
+    for (size_t i = 0; i < n; i++)
+        sink += cmap_find(ct, keys[i])->value;
+    t2 = now();
+    cmap_delete(ct);
+    report("int-c", "insert", n, t1 - t0);
+    report("int-c", "find", n, t2 - t1);
+
+    t0 = now();
+    u64map_tree *ut = u64map_new();
+    for (size_t i = 0; i < n; i++)
+        u64map_insert(ut, (uint64_t)keys[i] << 31, i);
+    t1 = now();
+    for (size_t i = 0; i < n; i++)
+        sink += u64map_find(ut, (uint64_t)keys[i] << 31)->value;
+    t2 = now();
+    u64map_delete(ut);
+    report("u64", "insert", n, t1 - t0);
+    report("u64", "find", n, t2 - t1);
+
+    t0 = now();
+    smap_tree *st = smap_new();
+    for (size_t i = 0; i < n; i++)
+        smap_insert(st, strs[i], i);
+    t1 = now();
+    for (size_t i = 0; i < n; i++)
+        sink += smap_find(st, strs[i])->value;
+    t2 = now();
+    smap_delete(st);
+    report("string", "insert", n, t1 - t0);
+    report("string", "find", n, t2 - t1);
+
+    if (sink == 1)
+        printf("\n");
+    free(keys);
+    free(strs);
+    return 0;
+}
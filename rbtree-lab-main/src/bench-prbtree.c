@@ -0,0 +1,120 @@
+#include "prbtree.h"
+#include "rbtree.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// 쓰기 비용 비교: rbtree, 스냅숏 없는 prbtree, -k번 쓸 때마다 스냅숏을 뜨는 prbtree
+// (새 스냅숏을 뜨면 이전 것은 놓음 = 내보내기가 끝난 셈). 결과는 연산당 ns.
+// 스냅숏이 살아 있는 동안 처음 건드리는 경로만 복사되므로 k가 작을수록 비쌈.
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void report(const char *tree, double ins, double era, size_t n) {
+    printf("%-18s %9.1f %9.1f\n", tree, ins * 1e9 / n, era * 1e9 / n);
+}
+
+// every번 쓸 때마다 스냅숏 (0이면 안 뜸)
+static void run_prbtree(const key_t *keys, size_t n, size_t every) {
+    prbtree *t = new_prbtree();
+    prbtree *snap = NULL;
+    double t0 = now();
+    for (size_t i = 0; i < n; i++) {
+        if (!prbtree_insert(t, keys[i])) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+        if (every && i % every == 0) {
+            delete_prbtree(snap);
+            snap = prbtree_snapshot(t);
+        }
+    }
+    double t1 = now();
+    for (size_t i = 0; i < n; i++) {
+        prbtree_erase(t, keys[i]);
+        if (every && i % every == 0) {
+            delete_prbtree(snap);
+            snap = prbtree_snapshot(t);
+        }
+    }
+    double t2 = now();
+    delete_prbtree(snap);
+    delete_prbtree(t);
+
+    char name[32];
+    if (every)
+        snprintf(name, sizeof(name), "prbtree snap/%zu", every);
+    else
+        snprintf(name, sizeof(name), "prbtree");
+    report(name, t1 - t0, t2 - t1, n);
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = 1000000;
+    unsigned int seed = 1;
+    int c;
+
+    while ((c = getopt(argc, argv, "n:s:h")) != -1) {
+        switch (c) {
+        case 'n':
+            n = (size_t)strtod(optarg, NULL);
+            break;
+        case 's':
+            seed = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-n keys] [-s seed]\n", argv[0]);
+            exit(c == 'h' ? 0 : 1);
+        }
+    }
+
+    key_t *keys = malloc(n * sizeof(key_t));
+    key_t *out = malloc(n * sizeof(key_t));
+    if (!keys || !out) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    srand(seed);
+    for (size_t i = 0; i < n; i++)
+        keys[i] = rand();
+
+    printf("%zu keys\n%-18s %9s %9s  (ns/op)\n", n, "tree", "insert", "erase");
+    rbtree *rt = new_rbtree();
+    double t0 = now();
+    for (size_t i = 0; i < n; i++)
+        rbtree_insert(rt, keys[i]);
+    double t1 = now();
+    for (size_t i = 0; i < n; i++)
+        rbtree_erase(rt, rbtree_find(rt, keys[i]));
+    double t2 = now();
+    delete_rbtree(rt);
+    report("rbtree", t1 - t0, t2 - t1, n);
+
+    run_prbtree(keys, n, 0);
+    run_prbtree(keys, n, 10000);
+    run_prbtree(keys, n, 100);
+    run_prbtree(keys, n, 1);
+
+    // 스냅숏 뜨기는 트리 크기와 상관없이 O(1), 내보내기는 락 없이 O(n)
+    prbtree *t = new_prbtree();
+    for (size_t i = 0; i < n; i++)
+        prbtree_insert(t, keys[i]);
+    t0 = now();
+    prbtree *snap = prbtree_snapshot(t);
+    t1 = now();
+    size_t count = prbtree_to_array(snap, out, n);
+    t2 = now();
+    printf("snapshot %.0f ns, to_array of %zu keys %.1f ms\n", (t1 - t0) * 1e9, count,
+           (t2 - t1) * 1e3);
+    delete_prbtree(snap);
+    delete_prbtree(t);
+
+    free(keys);
+    free(out);
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include "rbtree.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// 키 n개짜리 트리 두 개의 union/intersection/difference를 스레드 수별로 잰다.
+// 두 트리는 키의 절반이 겹치고 노드 풀을 같이 씀. 비교용 naive는 t2를 돌면서
+// t1에 하나씩 insert하는 union (지금까지 하던 방식).
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static key_t *a_keys, *b_keys;
+static size_t n;
+
+static void make_trees(rbtree **t1, rbtree **t2) {
+    *t1 = new_rbtree();
+    *t2 = new_rbtree_shared(*t1);
+    if (!*t1 || !*t2 || rbtree_insert_bulk(*t1, a_keys, n) != (int)n ||
+        rbtree_insert_bulk(*t2, b_keys, n) != (int)n) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int max_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned int seed = 1;
+    int c;
+
+    n = 1000000;
+    while ((c = getopt(argc, argv, "n:t:s:h")) != -1) {
+        switch (c) {
+        case 'n':
+            n = (size_t)strtod(optarg, NULL);
+            break;
+        case 't':
+            max_threads = atoi(optarg);
+            break;
+        case 's':
+            seed = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-n keys per tree, e.g. 1e7] [-t max threads] [-s seed]\n",
+                    argv[0]);
+            exit(c == 'h' ? 0 : 1);
+        }
+    }
+    if (max_threads < 1)
+        max_threads = 1;
+
+    a_keys = malloc(n * sizeof(key_t));
+    b_keys = malloc(n * sizeof(key_t));
+    if (!a_keys || !b_keys) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    // a는 짝수, b는 절반이 a와 겹치는 키
+    srand(seed);
+    for (size_t i = 0; i < n; i++) {
+        a_keys[i] = (key_t)(i * 2);
+        b_keys[i] = (key_t)(i % 2 ? i * 2 : i * 2 + 1);
+    }
+    for (size_t i = n - 1; i > 0; i--) {
+        size_t j = (size_t)rand() % (i + 1);
+        key_t tmp = b_keys[i];
+        b_keys[i] = b_keys[j];
+        b_keys[j] = tmp;
+    }
+
+    rbtree *t1, *t2;
+    printf("%zu + %zu keys, %ld cpus online\n", n, n, sysconf(_SC_NPROCESSORS_ONLN));
+
+    make_trees(&t1, &t2);
+    double t0 = now();
+    for (node_t *p = rbtree_min(t2); p; p = rbtree_next(t2, p))
+        if (!rbtree_find(t1, p->key))
+            rbtree_insert(t1, p->key);
+    printf("%-8s %7s %9.1f ms\n", "naive", "union", (now() - t0) * 1e3);
+    delete_rbtree(t2);
+    delete_rbtree(t1);
+
+    static const char *names[] = {"union", "inter", "diff"};
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        double ms[3];
+        for (int op = 0; op < 3; op++) {
+            make_trees(&t1, &t2);
+            t0 = now();
+            if (op == 0)
+                rbtree_union(t1, t2, threads);
+            else if (op == 1)
+                rbtree_intersection(t1, t2, threads);
+            else
+                rbtree_difference(t1, t2, threads);
+            ms[op] = (now() - t0) * 1e3;
+            delete_rbtree(t2);
+            delete_rbtree(t1);
+        }
+        printf("%2d thr   ", threads);
+        for (int op = 0; op < 3; op++)
+            printf(" %s %9.1f ms", names[op], ms[op]);
+        printf("\n");
+        fflush(stdout);
+    }
+
+    free(a_keys);
+    free(b_keys);
+    return 0;
+}
@@ -0,0 +1,193 @@
+#include "rbtree.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// 노드 할당 비용이 드러나는 단계별 처리량을 잽니다.
+// bench는 노드 slab, bench-calloc은 노드마다 malloc/free 하는 빌드에요.
+// bench-os는 서브트리 크기를 유지하는 빌드라 insert/erase 비용 차이가 보여요.
+// load-* 단계는 시작할 때 키 집합을 통째로 올리는 방법들을 비교해요.
+// range는 rbtree_range가 돌려준 키 수를 ops로 셉니다.
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int comp(const void *p1, const void *p2) {
+    key_t a = *(const key_t *)p1, b = *(const key_t *)p2;
+    return (a > b) - (a < b);
+}
+
+static void report(const char *phase, size_t ops, double secs) {
+    printf("%-10s %10zu ops %9.3f ms %8.2f Mops/s\n",
+           phase, ops, secs * 1e3, ops / secs / 1e6);
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = 1000000;
+    int rounds = 3;
+    unsigned int seed = 1;
+    int c;
+
+    while ((c = getopt(argc, argv, "n:r:s:h")) != -1) {
+        switch (c) {
+        case 'n':
+            n = strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            rounds = atoi(optarg);
+            break;
+        case 's':
+            seed = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-n keys] [-r rounds] [-s seed]\n", argv[0]);
+            exit(c == 'h' ? 0 : 1);
+        }
+    }
+    if (n < 2 || rounds < 1) {
+        fprintf(stderr, "need at least 2 keys and 1 round\n");
+        exit(1);
+    }
+
+    key_t *keys = malloc(n * sizeof(key_t));
+    node_t **nodes = malloc(n * sizeof(node_t *));
+    if (!keys || !nodes) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    srand(seed);
+    for (size_t i = 0; i < n; i++)
+        keys[i] = rand();
+
+    double t_insert = 0, t_churn = 0, t_erase = 0, t_delete = 0;
+    for (int r = 0; r < rounds; r++) {
+        rbtree *t = new_rbtree();
+        double t0 = now();
+        for (size_t i = 0; i < n; i++)
+            nodes[i] = rbtree_insert(t, keys[i]);
+        double t1 = now();
+
+        // 절반을 지우고 다시 넣기: erase한 노드가 바로 재사용되는 구간
+        for (size_t i = 0; i < n; i += 2)
+            rbtree_erase(t, nodes[i]);
+        for (size_t i = 0; i < n; i += 2)
+            nodes[i] = rbtree_insert(t, keys[i]);
+        double t2 = now();
+
+        // 키가 무작위라 삽입 순서대로 지워도 위치는 제각각.
+        // 앞쪽 절반은 하나씩 erase, 나머지는 delete_rbtree로 한 번에
+        for (size_t i = 0; i < n / 2; i++)
+            rbtree_erase(t, nodes[i]);
+        double t3 = now();
+        delete_rbtree(t);
+        double t4 = now();
+
+        t_insert += t1 - t0;
+        t_churn += t2 - t1;
+        t_erase += t3 - t2;
+        t_delete += t4 - t3;
+    }
+
+    // 정렬된 키를 하나씩 insert / from_sorted_array / 정렬 안 된 키를 insert_bulk
+    key_t *sorted = malloc(n * sizeof(key_t));
+    if (!sorted) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < n; i++)
+        sorted[i] = keys[i];
+    qsort(sorted, n, sizeof(key_t), comp);
+
+    // 키 100개 정도가 들어가는 구간을 n / 100번 질의
+    double t_range = 0;
+    size_t range_keys = 0;
+    key_t *out = malloc(n * sizeof(key_t));
+    if (!out) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    for (int r = 0; r < rounds; r++) {
+        rbtree *t = rbtree_from_sorted_array(sorted, n);
+        key_t width = (key_t)(RAND_MAX / n * 100);
+        double t0 = now();
+        for (size_t i = 0; i < n / 100; i++) {
+            // RAND_MAX 근처 키에서 int가 넘치지 않도록 끝을 자름
+            key_t hi = keys[i] > INT_MAX - width ? INT_MAX : keys[i] + width;
+            range_keys += rbtree_range(t, keys[i], hi, out, n);
+        }
+        double t1 = now();
+        delete_rbtree(t);
+        t_range += t1 - t0;
+    }
+    free(out);
+
+    double t_load_ins = 0, t_load_arr = 0, t_load_bulk = 0;
+    for (int r = 0; r < rounds; r++) {
+        rbtree *t = new_rbtree();
+        double t0 = now();
+        for (size_t i = 0; i < n; i++)
+            rbtree_insert(t, sorted[i]);
+        double t1 = now();
+        delete_rbtree(t);
+
+        double t2 = now();
+        t = rbtree_from_sorted_array(sorted, n);
+        double t3 = now();
+        delete_rbtree(t);
+
+        t = new_rbtree();
+        double t4 = now();
+        rbtree_insert_bulk(t, keys, n);
+        double t5 = now();
+        delete_rbtree(t);
+
+        t_load_ins += t1 - t0;
+        t_load_arr += t3 - t2;
+        t_load_bulk += t5 - t4;
+    }
+
+#ifdef RBTREE_ORDER_STAT
+    // 무작위 순위의 select와 무작위 키의 rank를 n번씩
+    double t_select = 0, t_rank = 0;
+    size_t sink = 0;
+    for (int r = 0; r < rounds; r++) {
+        rbtree *t = rbtree_from_sorted_array(sorted, n);
+        double t0 = now();
+        for (size_t i = 0; i < n; i++)
+            sink += rbtree_select(t, (size_t)keys[i] % n)->key;
+        double t1 = now();
+        for (size_t i = 0; i < n; i++)
+            sink += rbtree_rank(t, keys[i]);
+        double t2 = now();
+        delete_rbtree(t);
+        t_select += t1 - t0;
+        t_rank += t2 - t1;
+    }
+    if (sink == 1)
+        printf("\n");
+#endif
+
+    printf("%zu keys, %d rounds (per-round average)\n", n, rounds);
+    report("insert", n, t_insert / rounds);
+    report("churn", n, t_churn / rounds);
+    report("erase", n / 2, t_erase / rounds);
+    report("delete", n - n / 2, t_delete / rounds);
+    report("load-ins", n, t_load_ins / rounds);
+    report("load-arr", n, t_load_arr / rounds);
+    report("load-bulk", n, t_load_bulk / rounds);
+    report("range", range_keys / rounds, t_range / rounds);
+#ifdef RBTREE_ORDER_STAT
+    report("select", n, t_select / rounds);
+    report("rank", n, t_rank / rounds);
+#endif
+
+    free(keys);
+    free(sorted);
+    free(nodes);
+    return 0;
+}
@@ -0,0 +1,468 @@
+#include "bptree.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define LEAF_MIN (BPTREE_LEAF_KEYS / 2)
+#define INNER_MIN (BPTREE_INNER_KEYS / 2)
+
+//keys[0, n)에서 key보다 작은 키 개수 = lower bound 위치.
+//정렬돼 있으니 찾는 대신 4개씩 비교해서 세기만 함 (분기 없음)
+static inline int count_less(const key_t *keys, int n, key_t key)
+{
+  int i = 0, count = 0;
+#ifdef __SSE2__
+  __m128i k = _mm_set1_epi32(key);
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)(keys + i));
+    count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(v, k))));
+  }
+#endif
+  for (; i < n; i++)
+    count += keys[i] < key;
+  return count;
+}
+
+//key 이하인 키 개수 = upper bound 위치
+static inline int count_less_equal(const key_t *keys, int n, key_t key)
+{
+  int i = 0, count = 0;
+#ifdef __SSE2__
+  __m128i k = _mm_set1_epi32(key);
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)(keys + i));
+    count += 4 - __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, k))));
+  }
+#endif
+  for (; i < n; i++)
+    count += keys[i] <= key;
+  return count;
+}
+
+//노드 크기가 64의 배수라 캐시 라인에 맞춰 받음
+static bptree_leaf *alloc_leaf(void)
+{
+  return (bptree_leaf *)aligned_alloc(64, sizeof(bptree_leaf));
+}
+
+static bptree_inner *alloc_inner(void)
+{
+  return (bptree_inner *)aligned_alloc(64, sizeof(bptree_inner));
+}
+
+//삽입 한 번은 리프 하나와 내부 노드 height + 1개까지 새로 만들 수 있음.
+//미리 받아 두면 분할 도중에 할당이 실패할 일이 없음
+static int reserve(bptree *t)
+{
+  while (t->n_spare_leaves < 1)
+  {
+    bptree_leaf *leaf = alloc_leaf();
+    if (!leaf)
+      return 0;
+    leaf->next = t->spare_leaves;
+    t->spare_leaves = leaf;
+    t->n_spare_leaves++;
+  }
+  while (t->n_spare_inners < t->height + 1)
+  {
+    bptree_inner *in = alloc_inner();
+    if (!in)
+      return 0;
+    in->child[0] = t->spare_inners;
+    t->spare_inners = in;
+    t->n_spare_inners++;
+  }
+  return 1;
+}
+
+static bptree_leaf *take_leaf(bptree *t)
+{
+  bptree_leaf *leaf = t->spare_leaves;
+  t->spare_leaves = leaf->next;
+  t->n_spare_leaves--;
+  return leaf;
+}
+
+static bptree_inner *take_inner(bptree *t)
+{
+  bptree_inner *in = t->spare_inners;
+  t->spare_inners = (bptree_inner *)in->child[0];
+  t->n_spare_inners--;
+  return in;
+}
+
+bptree *new_bptree(void) {
+  bptree *t = (bptree *)calloc(1, sizeof(bptree));
+  if (!t)
+    return NULL;
+  bptree_leaf *leaf = alloc_leaf();
+  if (!leaf)
+  {
+    free(t);
+    return NULL;
+  }
+  leaf->n = 0;
+  leaf->next = NULL;
+  t->root = leaf;
+  return t;
+}
+
+static void free_subtree(void *node, int level)
+{
+  if (level > 0)
+  {
+    bptree_inner *in = (bptree_inner *)node;
+    for (int i = 0; i <= in->n; i++)
+      free_subtree(in->child[i], level - 1);
+  }
+  free(node);
+}
+
+void delete_bptree(bptree *t) {
+  if (!t)
+    return;
+  free_subtree(t->root, t->height);
+  while (t->spare_leaves)
+    free(take_leaf(t));
+  while (t->spare_inners)
+    free(take_inner(t));
+  free(t);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+//node(높이 level) 아래에 key를 넣음. 넘쳐서 나눴으면 1을 돌려주고
+//오른쪽 반을 *right에, 그 최소 키를 *sep에 담음
+static int insert_rec(bptree *t, void *node, int level, key_t key,
+                      key_t *sep, void **right)
+{
+  if (level == 0)
+  {
+    bptree_leaf *leaf = (bptree_leaf *)node;
+    int pos = count_less(leaf->keys, leaf->n, key);
+    if (leaf->n < BPTREE_LEAF_KEYS)
+    {
+      memmove(leaf->keys + pos + 1, leaf->keys + pos, (leaf->n - pos) * sizeof(key_t));
+      leaf->keys[pos] = key;
+      leaf->n++;
+      return 0;
+    }
+
+    //반으로 나누고 들어갈 쪽에 넣음
+    bptree_leaf *r = take_leaf(t);
+    int half = BPTREE_LEAF_KEYS / 2;
+    r->n = BPTREE_LEAF_KEYS - half;
+    memcpy(r->keys, leaf->keys + half, r->n * sizeof(key_t));
+    leaf->n = half;
+    r->next = leaf->next;
+    leaf->next = r;
+    bptree_leaf *dst = leaf;
+    if (pos > half)
+    {
+      dst = r;
+      pos -= half;
+    }
+    memmove(dst->keys + pos + 1, dst->keys + pos, (dst->n - pos) * sizeof(key_t));
+    dst->keys[pos] = key;
+    dst->n++;
+    *sep = r->keys[0];
+    *right = r;
+    return 1;
+  }
+
+  bptree_inner *in = (bptree_inner *)node;
+  int i = count_less(in->keys, in->n, key);
+  key_t csep;
+  void *cright;
+  if (!insert_rec(t, in->child[i], level - 1, key, &csep, &cright))
+    return 0;
+
+  if (in->n < BPTREE_INNER_KEYS)
+  {
+    memmove(in->keys + i + 1, in->keys + i, (in->n - i) * sizeof(key_t));
+    memmove(in->child + i + 2, in->child + i + 1, (in->n - i) * sizeof(void *));
+    in->keys[i] = csep;
+    in->child[i + 1] = cright;
+    in->n++;
+    return 0;
+  }
+
+  //키 INNER_KEYS + 1개를 늘어놓고 가운데 키를 위로 올림
+  key_t keys[BPTREE_INNER_KEYS + 1];
+  void *child[BPTREE_INNER_KEYS + 2];
+  memcpy(keys, in->keys, i * sizeof(key_t));
+  keys[i] = csep;
+  memcpy(keys + i + 1, in->keys + i, (in->n - i) * sizeof(key_t));
+  memcpy(child, in->child, (i + 1) * sizeof(void *));
+  child[i + 1] = cright;
+  memcpy(child + i + 2, in->child + i + 1, (in->n - i) * sizeof(void *));
+
+  bptree_inner *r = take_inner(t);
+  int total = BPTREE_INNER_KEYS + 1, mid = total / 2;
+  in->n = mid;
+  memcpy(in->keys, keys, mid * sizeof(key_t));
+  memcpy(in->child, child, (mid + 1) * sizeof(void *));
+  r->n = total - mid - 1;
+  memcpy(r->keys, keys + mid + 1, r->n * sizeof(key_t));
+  memcpy(r->child, child + mid + 1, (r->n + 1) * sizeof(void *));
+  *sep = keys[mid];
+  *right = r;
+  return 1;
+}
+
+int bptree_insert(bptree *t, const key_t key) {
+  if (!t || !reserve(t))
+    return 0;
+  key_t sep;
+  void *right;
+  if (insert_rec(t, t->root, t->height, key, &sep, &right))
+  {
+    //루트가 나뉘면 한 층 올림
+    bptree_inner *root = take_inner(t);
+    root->n = 1;
+    root->keys[0] = sep;
+    root->child[0] = t->root;
+    root->child[1] = right;
+    t->root = root;
+    t->height++;
+  }
+  t->size++;
+  return 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+//key가 들어 있을 수 있는 가장 왼쪽 리프
+static bptree_leaf *find_leaf(const bptree *t, key_t key)
+{
+  void *node = t->root;
+  for (int level = t->height; level > 0; level--)
+  {
+    bptree_inner *in = (bptree_inner *)node;
+    node = in->child[count_less(in->keys, in->n, key)];
+  }
+  return (bptree_leaf *)node;
+}
+
+//key 이상인 첫 키의 자리. 내려온 리프에 없으면 다음 리프의 맨 앞
+static const key_t *lower_bound(const bptree *t, key_t key, const bptree_leaf **leafp)
+{
+  const bptree_leaf *leaf = find_leaf(t, key);
+  int pos = count_less(leaf->keys, leaf->n, key);
+  if (pos == leaf->n)
+  {
+    leaf = leaf->next;
+    pos = 0;
+  }
+  *leafp = leaf;
+  return leaf ? &leaf->keys[pos] : NULL;
+}
+
+const key_t *bptree_find(const bptree *t, const key_t key) {
+  if (!t)
+    return NULL;
+  const bptree_leaf *leaf;
+  const key_t *p = lower_bound(t, key, &leaf);
+  if (!p || *p != key)
+    return NULL;
+  return p;
+}
+
+static bptree_leaf *first_leaf(const bptree *t)
+{
+  void *node = t->root;
+  for (int level = t->height; level > 0; level--)
+    node = ((bptree_inner *)node)->child[0];
+  return (bptree_leaf *)node;
+}
+
+const key_t *bptree_min(const bptree *t) {
+  if (!t || t->size == 0)
+    return NULL;
+  return &first_leaf(t)->keys[0];
+}
+
+const key_t *bptree_max(const bptree *t) {
+  if (!t || t->size == 0)
+    return NULL;
+  void *node = t->root;
+  for (int level = t->height; level > 0; level--)
+  {
+    bptree_inner *in = (bptree_inner *)node;
+    node = in->child[in->n];
+  }
+  bptree_leaf *leaf = (bptree_leaf *)node;
+  return &leaf->keys[leaf->n - 1];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+//in->child[i]에 키가 너무 적으면 형제에게서 하나 빌리고, 형제도 여유가 없으면 합침
+static void fix_leaf(bptree_inner *in, int i)
+{
+  bptree_leaf *c = (bptree_leaf *)in->child[i];
+  if (c->n >= LEAF_MIN)
+    return;
+  bptree_leaf *l = i > 0 ? (bptree_leaf *)in->child[i - 1] : NULL;
+  bptree_leaf *r = i < in->n ? (bptree_leaf *)in->child[i + 1] : NULL;
+
+  if (l && l->n > LEAF_MIN)
+  {
+    memmove(c->keys + 1, c->keys, c->n * sizeof(key_t));
+    c->keys[0] = l->keys[--l->n];
+    c->n++;
+    in->keys[i - 1] = c->keys[0];
+    return;
+  }
+  if (r && r->n > LEAF_MIN)
+  {
+    c->keys[c->n++] = r->keys[0];
+    memmove(r->keys, r->keys + 1, --r->n * sizeof(key_t));
+    in->keys[i] = r->keys[0];
+    return;
+  }
+
+  //왼쪽 형제가 있으면 c를 거기에, 없으면 오른쪽 형제를 c에 붙임
+  int s = l ? i - 1 : i;
+  bptree_leaf *a = (bptree_leaf *)in->child[s], *b = (bptree_leaf *)in->child[s + 1];
+  memcpy(a->keys + a->n, b->keys, b->n * sizeof(key_t));
+  a->n += b->n;
+  a->next = b->next;
+  free(b);
+  memmove(in->keys + s, in->keys + s + 1, (in->n - s - 1) * sizeof(key_t));
+  memmove(in->child + s + 1, in->child + s + 2, (in->n - s - 1) * sizeof(void *));
+  in->n--;
+}
+
+//내부 노드 버전. 빌릴 때는 부모의 키를 내려받고 형제의 끝 키를 올림
+static void fix_inner(bptree_inner *in, int i)
+{
+  bptree_inner *c = (bptree_inner *)in->child[i];
+  if (c->n >= INNER_MIN)
+    return;
+  bptree_inner *l = i > 0 ? (bptree_inner *)in->child[i - 1] : NULL;
+  bptree_inner *r = i < in->n ? (bptree_inner *)in->child[i + 1] : NULL;
+
+  if (l && l->n > INNER_MIN)
+  {
+    memmove(c->keys + 1, c->keys, c->n * sizeof(key_t));
+    memmove(c->child + 1, c->child, (c->n + 1) * sizeof(void *));
+    c->keys[0] = in->keys[i - 1];
+    c->child[0] = l->child[l->n];
+    c->n++;
+    in->keys[i - 1] = l->keys[--l->n];
+    return;
+  }
+  if (r && r->n > INNER_MIN)
+  {
+    c->keys[c->n] = in->keys[i];
+    c->child[c->n + 1] = r->child[0];
+    c->n++;
+    in->keys[i] = r->keys[0];
+    memmove(r->keys, r->keys + 1, (r->n - 1) * sizeof(key_t));
+    memmove(r->child, r->child + 1, r->n * sizeof(void *));
+    r->n--;
+    return;
+  }
+
+  int s = l ? i - 1 : i;
+  bptree_inner *a = (bptree_inner *)in->child[s], *b = (bptree_inner *)in->child[s + 1];
+  a->keys[a->n] = in->keys[s];
+  memcpy(a->keys + a->n + 1, b->keys, b->n * sizeof(key_t));
+  memcpy(a->child + a->n + 1, b->child, (b->n + 1) * sizeof(void *));
+  a->n += b->n + 1;
+  free(b);
+  memmove(in->keys + s, in->keys + s + 1, (in->n - s - 1) * sizeof(key_t));
+  memmove(in->child + s + 1, in->child + s + 2, (in->n - s - 1) * sizeof(void *));
+  in->n--;
+}
+
+//node 아래에서 key 하나를 지움. 같은 키가 구분 키 양쪽에 걸쳐 있을 수 있어서
+//구분 키가 key와 같으면 오른쪽 자식도 찾아봄
+static int erase_rec(void *node, int level, key_t key)
+{
+  if (level == 0)
+  {
+    bptree_leaf *leaf = (bptree_leaf *)node;
+    int pos = count_less(leaf->keys, leaf->n, key);
+    if (pos == leaf->n || leaf->keys[pos] != key)
+      return 0;
+    memmove(leaf->keys + pos, leaf->keys + pos + 1, (leaf->n - pos - 1) * sizeof(key_t));
+    leaf->n--;
+    return 1;
+  }
+
+  bptree_inner *in = (bptree_inner *)node;
+  for (int i = count_less(in->keys, in->n, key); ; i++)
+  {
+    if (erase_rec(in->child[i], level - 1, key))
+    {
+      if (level == 1)
+        fix_leaf(in, i);
+      else
+        fix_inner(in, i);
+      return 1;
+    }
+    if (i == in->n || in->keys[i] != key)
+      return 0;
+  }
+}
+
+int bptree_erase(bptree *t, const key_t key) {
+  if (!t || !erase_rec(t->root, t->height, key))
+    return 0;
+  //루트에 자식이 하나만 남으면 한 층 내림
+  if (t->height > 0 && ((bptree_inner *)t->root)->n == 0)
+  {
+    bptree_inner *old = (bptree_inner *)t->root;
+    t->root = old->child[0];
+    t->height--;
+    free(old);
+  }
+  t->size--;
+  return 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+//리프 사슬만 따라가며 복사
+int bptree_to_array(const bptree *t, key_t *arr, const size_t n) {
+  if (!t || !arr)
+    return 0;
+  size_t count = 0;
+  for (const bptree_leaf *leaf = first_leaf(t); leaf && count < n; leaf = leaf->next)
+  {
+    size_t m = leaf->n < n - count ? leaf->n : n - count;
+    memcpy(arr + count, leaf->keys, m * sizeof(key_t));
+    count += m;
+  }
+  return (int)count;
+}
+
+int bptree_range(const bptree *t, const key_t lo, const key_t hi, key_t *arr, const size_t n) {
+  if (!t || !arr || lo > hi)
+    return 0;
+  const bptree_leaf *leaf;
+  const key_t *p = lower_bound(t, lo, &leaf);
+  if (!p)
+    return 0;
+  int pos = (int)(p - leaf->keys);
+  size_t count = 0;
+  for (; leaf && count < n; leaf = leaf->next, pos = 0)
+  {
+    //이 리프에서 hi 이하인 끝까지
+    int end = count_less_equal(leaf->keys, leaf->n, hi);
+    size_t m = end > pos ? (size_t)(end - pos) : 0;
+    if (m > n - count)
+      m = n - count;
+    memcpy(arr + count, leaf->keys + pos, m * sizeof(key_t));
+    count += m;
+    if (end < leaf->n)
+      break;
+  }
+  return (int)count;
+}
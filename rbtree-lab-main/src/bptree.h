@@ -0,0 +1,48 @@
+#ifndef _BPTREE_H_
+#define _BPTREE_H_
+
+#include "rbtree.h"
+
+// rbtree.h와 같은 일을 하는 B+-tree (ordered multiset, key_t 키).
+// 노드 하나가 캐시 라인 몇 개에 딱 맞고, 키는 노드 안에서 SIMD로 찾습니다.
+// 리프끼리는 next로 이어져 있어 to_array/range가 리프만 훑습니다.
+// 키 자리를 가리키는 포인터(find/min/max)는 트리를 바꾸면 무효가 됩니다.
+
+#define BPTREE_LEAF_KEYS 28   // 리프 128바이트 (캐시 라인 2개)
+#define BPTREE_INNER_KEYS 20  // 내부 노드 256바이트 (캐시 라인 4개)
+
+typedef struct bptree_leaf {
+  key_t keys[BPTREE_LEAF_KEYS];
+  int n;
+  struct bptree_leaf *next;
+} bptree_leaf;
+
+typedef struct bptree_inner {
+  key_t keys[BPTREE_INNER_KEYS];  // child[i]의 키 <= keys[i] <= child[i + 1]의 키
+  int n;                          // 키 개수 (자식은 n + 1개)
+  void *child[BPTREE_INNER_KEYS + 1];
+} bptree_inner;
+
+typedef struct {
+  void *root;    // height == 0이면 리프, 아니면 내부 노드
+  int height;
+  size_t size;
+  bptree_leaf *spare_leaves;   // 삽입이 중간에 실패하지 않도록 미리 받아 둔 노드
+  bptree_inner *spare_inners;  // (leaf는 next, inner는 child[0]로 연결)
+  int n_spare_leaves, n_spare_inners;
+} bptree;
+
+bptree *new_bptree(void);
+void delete_bptree(bptree *);
+
+int bptree_insert(bptree *, const key_t);              // 1 성공, 0 메모리 부족
+const key_t *bptree_find(const bptree *, const key_t);  // 없으면 NULL
+const key_t *bptree_min(const bptree *);
+const key_t *bptree_max(const bptree *);
+int bptree_erase(bptree *, const key_t);               // key 하나를 지움, 없으면 0
+
+int bptree_to_array(const bptree *, key_t *, const size_t);
+// [lo, hi] 구간의 키를 순서대로 최대 n개 복사, 복사한 개수를 돌려줌
+int bptree_range(const bptree *, const key_t, const key_t, key_t *, const size_t);
+
+#endif  // _BPTREE_H_
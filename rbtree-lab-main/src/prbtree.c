@@ -0,0 +1,382 @@
+#include "prbtree.h"
+#include <stdlib.h>
+
+//부모 포인터가 없으니 내려온 경로를 배열에 담아 두고 fix up에 씀.
+//높이는 2 log2(n + 1)을 넘지 않고, erase fix up의 회전으로 한 칸 더 늘 수 있음
+#define PRB_MAX_DEPTH 132
+
+static int is_red(const prbtree_node *node)
+{
+  return node && node->color == RBTREE_RED;
+}
+
+static void ref_node(prbtree_node *node)
+{
+  __atomic_add_fetch(&node->refs, 1, __ATOMIC_RELAXED);
+}
+
+//refs를 하나 줄이고 0이 되면 반환, 자식도 차례로 놓음
+static void release(prbtree_node *node)
+{
+  while (node && __atomic_sub_fetch(&node->refs, 1, __ATOMIC_ACQ_REL) == 0)
+  {
+    prbtree_node *right = node->right;
+    release(node->left);
+    free(node);
+    node = right;
+  }
+}
+
+prbtree *new_prbtree(void) {
+  return (prbtree *)calloc(1, sizeof(prbtree));
+}
+
+void delete_prbtree(prbtree *t) {
+  if (!t)
+    return;
+  release(t->root);
+  while (t->spare)
+  {
+    prbtree_node *next = t->spare->left;
+    free(t->spare);
+    t->spare = next;
+  }
+  free(t);
+}
+
+prbtree *prbtree_snapshot(prbtree *t) {
+  if (!t)
+    return NULL;
+  prbtree *s = (prbtree *)calloc(1, sizeof(prbtree));
+  if (!s)
+    return NULL;
+  s->root = t->root;
+  s->size = t->size;
+  if (s->root)
+    ref_node(s->root);
+  return s;
+}
+
+//insert/erase 한 번이 새로 쓸 수 있는 노드를 미리 받아 둠:
+//경로 복사(높이) + 경로마다 삼촌/형제 복사(높이) + 새 노드와 erase 끝의 회전 몇 개.
+//중간에 받다가 실패하면 트리가 반쯤 고쳐진 채로 남으니 시작 전에 다 받음
+static int reserve(prbtree *t)
+{
+  int height = 2;
+  for (size_t n = t->size + 1; n > 1; n >>= 1)
+    height += 2;
+  const int need = 2 * height + 5;
+  while (t->n_spare < need)
+  {
+    prbtree_node *node = (prbtree_node *)malloc(sizeof(prbtree_node));
+    if (!node)
+      return 0;
+    node->left = t->spare;
+    t->spare = node;
+    t->n_spare++;
+  }
+  return 1;
+}
+
+//erase로 빠진 노드는 다음 insert가 쓰도록 spare로 (너무 많이 쌓이면 반환)
+#define PRB_MAX_SPARE 256
+
+static void put_spare(prbtree *t, prbtree_node *node)
+{
+  if (t->n_spare >= PRB_MAX_SPARE)
+  {
+    free(node);
+    return;
+  }
+  node->left = t->spare;
+  t->spare = node;
+  t->n_spare++;
+}
+
+static prbtree_node *take_spare(prbtree *t)
+{
+  prbtree_node *node = t->spare;
+  t->spare = node->left;
+  t->n_spare--;
+  node->refs = 1;
+  return node;
+}
+
+//slot이 가리키는 노드를 이 트리만 쓰게 만들어 돌려줌 (slot을 가진 부모는 이미 이 트리 것).
+//다른 버전도 쓰고 있으면(refs > 1) 복사본으로 바꿈. 복사본이 자식을 같이 가리키게 되니
+//자식의 refs가 늘어, 그 아래로 내려갈 때도 차례로 복사됨
+static prbtree_node *own(prbtree *t, prbtree_node **slot)
+{
+  prbtree_node *node = *slot;
+  if (__atomic_load_n(&node->refs, __ATOMIC_ACQUIRE) == 1)
+    return node;
+  prbtree_node *copy = take_spare(t);
+  copy->color = node->color;
+  copy->key = node->key;
+  copy->left = node->left;
+  copy->right = node->right;
+  if (copy->left)
+    ref_node(copy->left);
+  if (copy->right)
+    ref_node(copy->right);
+  *slot = copy;
+  release(node);
+  return copy;
+}
+
+static void rotate_left(prbtree_node **slot)
+{
+  prbtree_node *node = *slot;
+  prbtree_node *r_node = node->right;
+  node->right = r_node->left;
+  r_node->left = node;
+  *slot = r_node;
+}
+
+static void rotate_right(prbtree_node **slot)
+{
+  prbtree_node *node = *slot;
+  prbtree_node *l_node = node->left;
+  node->left = l_node->right;
+  l_node->right = node;
+  *slot = l_node;
+}
+
+//path[i]를 가리키는 자리
+static prbtree_node **slot_of(prbtree *t, prbtree_node **path, int i)
+{
+  if (i == 0)
+    return &t->root;
+  prbtree_node *parent = path[i - 1];
+  return parent->left == path[i] ? &parent->left : &parent->right;
+}
+
+int prbtree_insert(prbtree *t, const key_t key) {
+  if (!t || !reserve(t))
+    return 0;
+
+  //넣을 자리까지 내려가면서 경로의 노드를 이 트리 것으로
+  prbtree_node *path[PRB_MAX_DEPTH];
+  prbtree_node **slot = &t->root;
+  int i = 0;
+  while (*slot)
+  {
+    prbtree_node *cur = own(t, slot);
+    path[i++] = cur;
+    slot = cur->key > key ? &cur->left : &cur->right;
+  }
+  prbtree_node *node = take_spare(t);
+  node->color = RBTREE_RED;
+  node->key = key;
+  node->left = NULL;
+  node->right = NULL;
+  *slot = node;
+  path[i] = node;
+  t->size++;
+
+  //rbtree.c의 insert_fix_up과 같음. 부모는 path[i - 1], 할배는 path[i - 2]
+  while (i >= 2 && path[i - 1]->color == RBTREE_RED)
+  {
+    prbtree_node *parent = path[i - 1], *grandparent = path[i - 2];
+    const int parent_left = grandparent->left == parent;
+    prbtree_node **uncle = parent_left ? &grandparent->right : &grandparent->left;
+    //case 1: 삼촌이 레드다 (삼촌은 색만 바꾸지만 다른 버전과 같이 쓰면 복사)
+    if (is_red(*uncle))
+    {
+      own(t, uncle)->color = RBTREE_BLACK;
+      parent->color = RBTREE_BLACK;
+      grandparent->color = RBTREE_RED;
+      i -= 2;
+      continue;
+    }
+    //case 2, 3: 회전하는 노드는 모두 경로 위에 있어서 이미 이 트리 것
+    prbtree_node **top = slot_of(t, path, i - 2);
+    if (parent_left)
+    {
+      if (parent->right == path[i])
+      {
+        rotate_left(&grandparent->left);
+        parent = path[i];
+      }
+      rotate_right(top);
+    }
+    else
+    {
+      if (parent->left == path[i])
+      {
+        rotate_right(&grandparent->right);
+        parent = path[i];
+      }
+      rotate_left(top);
+    }
+    parent->color = RBTREE_BLACK;
+    grandparent->color = RBTREE_RED;
+    break;
+  }
+  t->root->color = RBTREE_BLACK;
+  return 1;
+}
+
+//path[i]의 left(1이면 왼쪽) 자식 자리에 검정이 하나 모자람. rbtree.c의 erase_fix_up과 같고,
+//형제와 그 자식은 고치기 전에 own으로 이 트리 것으로 만듦
+static void erase_fix_up(prbtree *t, prbtree_node **path, int i, int left)
+{
+  prbtree_node *node = left ? path[i]->left : path[i]->right;
+  while (i >= 0 && !is_red(node))
+  {
+    prbtree_node *parent = path[i];
+    prbtree_node *bro = own(t, left ? &parent->right : &parent->left);
+
+    if (bro->color == RBTREE_RED)
+    {
+      bro->color = RBTREE_BLACK;
+      parent->color = RBTREE_RED;
+      if (left)
+        rotate_left(slot_of(t, path, i));
+      else
+        rotate_right(slot_of(t, path, i));
+      //형제가 부모 자리로 올라왔으니 경로에 끼워 넣음
+      path[i + 1] = parent;
+      path[i] = bro;
+      i++;
+      bro = own(t, left ? &parent->right : &parent->left);
+    }
+
+    if (!is_red(bro->left) && !is_red(bro->right))
+    {
+      bro->color = RBTREE_RED;
+      node = parent;
+      i--;
+      left = i >= 0 && path[i]->left == node;
+      continue;
+    }
+
+    if (left)
+    {
+      if (!is_red(bro->right))
+      {
+        own(t, &bro->left)->color = RBTREE_BLACK;
+        bro->color = RBTREE_RED;
+        rotate_right(&parent->right);
+        bro = parent->right;
+      }
+      bro->color = parent->color;
+      parent->color = RBTREE_BLACK;
+      own(t, &bro->right)->color = RBTREE_BLACK;
+      rotate_left(slot_of(t, path, i));
+    }
+    else
+    {
+      if (!is_red(bro->left))
+      {
+        own(t, &bro->right)->color = RBTREE_BLACK;
+        bro->color = RBTREE_RED;
+        rotate_left(&parent->left);
+        bro = parent->left;
+      }
+      bro->color = parent->color;
+      parent->color = RBTREE_BLACK;
+      own(t, &bro->left)->color = RBTREE_BLACK;
+      rotate_right(slot_of(t, path, i));
+    }
+    node = t->root;
+    break;
+  }
+  //여기 오는 노드는 경로 위 노드나 루트라 이미 이 트리 것
+  if (node)
+    node->color = RBTREE_BLACK;
+}
+
+int prbtree_erase(prbtree *t, const key_t key) {
+  //없으면 경로를 복사하지 않도록 먼저 읽기만으로 확인
+  if (!t || !prbtree_find(t, key) || !reserve(t))
+    return 0;
+
+  prbtree_node *path[PRB_MAX_DEPTH];
+  prbtree_node **slot = &t->root;
+  int d = 0;
+  prbtree_node *target;
+  for (;;)
+  {
+    target = own(t, slot);
+    path[d++] = target;
+    if (target->key == key)
+      break;
+    slot = target->key > key ? &target->left : &target->right;
+  }
+
+  //자식이 둘이면 후계자의 키를 옮겨 오고 후계자 노드를 대신 지움
+  //(노드 포인터를 밖에 내주지 않으니 키만 옮겨도 됨)
+  if (target->left && target->right)
+  {
+    slot = &target->right;
+    for (;;)
+    {
+      prbtree_node *cur = own(t, slot);
+      path[d++] = cur;
+      if (!cur->left)
+        break;
+      slot = &cur->left;
+    }
+    target->key = path[d - 1]->key;
+  }
+
+  //지울 노드는 자식이 많아야 하나. 그 자식을 자리에 올림
+  prbtree_node *gone = path[d - 1];
+  prbtree_node **gone_slot = slot_of(t, path, d - 1);
+  prbtree_node *child = gone->left ? gone->left : gone->right;
+  const int parent = d - 2;
+  const int left = parent >= 0 && path[parent]->left == gone;
+  const color_t gone_color = gone->color;
+  *gone_slot = child;
+  put_spare(t, gone);  //refs가 1이었고 자식은 자리를 넘겨받았으니 그냥 반환
+  t->size--;
+
+  if (gone_color == RBTREE_BLACK)
+  {
+    if (is_red(child))
+      own(t, gone_slot)->color = RBTREE_BLACK;
+    else if (parent >= 0)
+      erase_fix_up(t, path, parent, left);
+  }
+  return 1;
+}
+
+int prbtree_find(const prbtree *t, const key_t key) {
+  if (!t)
+    return 0;
+  const prbtree_node *cur = t->root;
+  while (cur)
+  {
+    if (cur->key > key)
+      cur = cur->left;
+    else if (cur->key < key)
+      cur = cur->right;
+    else
+      return 1;
+  }
+  return 0;
+}
+
+size_t prbtree_size(const prbtree *t) {
+  return t ? t->size : 0;
+}
+
+static void inorder(const prbtree_node *node, key_t *arr, size_t n, size_t *count)
+{
+  while (node && *count < n)
+  {
+    inorder(node->left, arr, n, count);
+    if (*count < n)
+      arr[(*count)++] = node->key;
+    node = node->right;
+  }
+}
+
+int prbtree_to_array(const prbtree *t, key_t *arr, const size_t n) {
+  if (!t || !arr)
+    return 0;
+  size_t count = 0;
+  inorder(t->root, arr, n, &count);
+  return (int)count;
+}
@@ -0,0 +1,41 @@
+#ifndef _PRBTREE_H_
+#define _PRBTREE_H_
+
+#include "rbtree.h"
+
+// 스냅숏을 O(1)에 뜰 수 있는 persistent rbtree (ordered multiset, key_t 키).
+// 노드는 참조 횟수(refs)를 가지고 여러 버전이 같이 씁니다. insert/erase는
+// 다른 버전과 같이 쓰는 노드를 만나면 그 노드만 복사하므로(path copying)
+// 스냅숏이 없으면 rbtree처럼 제자리에서 고치고, 있으면 O(log n)개를 복사합니다.
+// 마지막 버전이 놓을 때(refs가 0이 될 때) 노드가 반환됩니다.
+//
+// 스냅숏은 쓰는 스레드에서 뜨고, 다른 스레드에서 읽고 놓아도 됩니다
+// (같이 쓰는 노드는 아무도 고치지 않고, refs는 atomic).
+
+typedef struct prbtree_node {
+  color_t color;
+  key_t key;
+  unsigned int refs;  // 이 노드를 가리키는 부모와 루트의 수
+  struct prbtree_node *left, *right;  // 없으면 NULL
+} prbtree_node;
+
+typedef struct {
+  prbtree_node *root;
+  size_t size;
+  prbtree_node *spare;  // 고치는 도중 복사가 실패하지 않도록 미리 받아 둔 노드 (left로 연결)
+  int n_spare;
+} prbtree;
+
+prbtree *new_prbtree(void);
+void delete_prbtree(prbtree *);  // 스냅숏도 이걸로 놓음
+// 지금 내용을 그대로 가진 새 트리. O(1), 노드는 모두 같이 씀.
+// 스냅숏도 보통 트리처럼 읽고 고칠 수 있고, 고쳐도 서로 영향이 없음
+prbtree *prbtree_snapshot(prbtree *);
+
+int prbtree_insert(prbtree *, const key_t);  // 1 성공, 0 메모리 부족
+int prbtree_erase(prbtree *, const key_t);   // key 하나를 지움, 없거나 메모리 부족이면 0
+int prbtree_find(const prbtree *, const key_t);  // 있으면 1
+size_t prbtree_size(const prbtree *);
+int prbtree_to_array(const prbtree *, key_t *, const size_t);
+
+#endif  // _PRBTREE_H_
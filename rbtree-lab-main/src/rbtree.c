@@ -1,96 +1,210 @@
 #include "rbtree.h"
+#include <limits.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
+
+//rbtree_conc의 읽기가 락 없이 같이 읽는 필드(root, left, right, key)는 insert/erase에서
+//atomic store로 씀. 그래야 data race가 아니고 컴파일러가 store를 쪼개거나 합치지 않음.
+//relaxed라 x86에서는 보통 mov와 같고, 새 노드의 순서는 rbtree_insert의 release가 맞춤
+#define STORE(p, v) __atomic_store_n(&(p), (v), __ATOMIC_RELAXED)
 
 rbtree *new_rbtree(void) {
   rbtree *p = (rbtree *)calloc(1, sizeof(rbtree));
   if (!p)
     return NULL;
 
-  node_t *nil_node = (node_t *)calloc(1, sizeof(node_t));
-  if (!nil_node)
+  node_pool *pool = (node_pool *)calloc(1, sizeof(node_pool));
+  if (!pool)
   {
     free(p);
     return NULL;
   }
+  node_t *nil_node = &pool->nil;
   nil_node->color = RBTREE_BLACK;
   nil_node->parent = nil_node;
   nil_node->left = nil_node;
   nil_node->right = nil_node;
+  pool->refs = 1;
 
+  p->pool = pool;
   p->nil = nil_node;
   p->root = nil_node;
 
   return p;
 }
 
-static void allFreeInTree(node_t *node, node_t *nil)
+rbtree *new_rbtree_shared(rbtree *t) {
+  if (!t)
+    return NULL;
+  rbtree *p = (rbtree *)calloc(1, sizeof(rbtree));
+  if (!p)
+    return NULL;
+  p->pool = t->pool;
+  p->pool->refs++;
+  p->nil = t->nil;
+  p->root = t->nil;
+  return p;
+}
+
+static void free_node(rbtree *t, node_t *node);
+
+static void free_subtree(rbtree *t, node_t *node)
 {
-  if (node == nil)
+  if (node == t->nil)
     return;
-  allFreeInTree(node->left, nil);
-  allFreeInTree(node->right, nil);
-  free(node);
+  free_subtree(t, node->left);
+  free_subtree(t, node->right);
+  free_node(t, node);
 }
 
 void delete_rbtree(rbtree *t) {
   if(!t)
     return;
-  allFreeInTree(t->root, t->nil);
-  free(t->nil);
+  node_pool *pool = t->pool;
+#ifdef RBTREE_NO_SLAB
+  free_subtree(t, t->root);
+  if (--pool->refs == 0)
+    free(pool);
+#else
+  //풀을 같이 쓰는 트리가 남아 있으면 노드만 free list로 돌려줌
+  if (--pool->refs > 0)
+    free_subtree(t, t->root);
+  else
+  {
+    //노드는 전부 chunk 안에 있으니 트리를 돌 필요 없이 chunk만 반환
+    node_chunk *c = pool->chunks;
+    while (c)
+    {
+      node_chunk *next = c->next;
+      free(c);
+      c = next;
+    }
+    free(pool);
+  }
+#endif
   free(t);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
+#define CHUNK_MIN_NODES 64
+#define CHUNK_MAX_NODES 4096
+
+#ifdef RBTREE_NO_SLAB
+static node_t *alloc_node(rbtree *t)
+{
+  return (node_t *)malloc(sizeof(node_t));
+}
+
+static void free_node(rbtree *t, node_t *node)
+{
+  free(node);
+}
+#else
+//free list에 있으면 재사용, 없으면 맨 앞 chunk에서 잘라 줌.
+//chunk가 다 차면 두 배 크기(최대 CHUNK_MAX_NODES)로 새로 받음
+static node_t *alloc_node(rbtree *t)
+{
+  node_pool *pool = t->pool;
+  node_t *node = pool->free_nodes;
+  if (node)
+  {
+    pool->free_nodes = node->parent;
+    return node;
+  }
+
+  node_chunk *c = pool->chunks;
+  if (!c || pool->chunk_used == c->cap)
+  {
+    size_t cap = c ? c->cap * 2 : CHUNK_MIN_NODES;
+    if (cap > CHUNK_MAX_NODES)
+      cap = CHUNK_MAX_NODES;
+    c = (node_chunk *)malloc(sizeof(node_chunk) + cap * sizeof(node_t));
+    if (!c)
+      return NULL;
+    c->cap = cap;
+    //새 chunk의 자리도 자식이 nil을 가리키게 해 둠: 락 없이 읽는 쪽(rbtree_conc)이
+    //어떤 자리를 보더라도 malloc이 준 쓰레기 포인터를 따라가지 않도록
+    for (size_t i = 0; i < cap; i++)
+      c->nodes[i].left = c->nodes[i].right = &pool->nil;
+    c->next = pool->chunks;
+    pool->chunks = c;
+    pool->chunk_used = 0;
+  }
+  return &c->nodes[pool->chunk_used++];
+}
+
+static void free_node(rbtree *t, node_t *node)
+{
+  node->parent = t->pool->free_nodes;
+  t->pool->free_nodes = node;
+}
+#endif
+
 static node_t *make_node(rbtree *t, color_t color, key_t key, node_t *parent)
 {
-  node_t *new_node = (node_t *)calloc(1, sizeof(node_t));
+  node_t *new_node = alloc_node(t);
   if (!new_node)
     return NULL;
+  //free list에서 온 자리는 지워지기 전에 읽던 쪽이 아직 볼 수 있음
   new_node->color = color;
-  new_node->key = key;
+  STORE(new_node->key, key);
   new_node->parent = parent;
-  new_node->left = t->nil;
-  new_node->right = t->nil;
+  STORE(new_node->left, t->nil);
+  STORE(new_node->right, t->nil);
+#ifdef RBTREE_ORDER_STAT
+  new_node->size = 1;
+#endif
 
   return new_node;
 }
-static  void L_rotate(rbtree *t, node_t *node)
+static inline void L_rotate(rbtree *t, node_t *node)
 {
   node_t *r_node = node->right;
-  node->right = r_node->left;
+  STORE(node->right, r_node->left);
   if (r_node->left != t->nil)
     r_node->left->parent = node;
   r_node->parent = node->parent;
   if (node->parent == t->nil)
-    t->root = r_node;
+    STORE(t->root, r_node);
   else if (node == node->parent->right)
-    node->parent->right = r_node;
+    STORE(node->parent->right, r_node);
   else
-    node->parent->left = r_node;
+    STORE(node->parent->left, r_node);
   node->parent = r_node;
-  r_node->left = node;
+  STORE(r_node->left, node);
+#ifdef RBTREE_ORDER_STAT
+  //r_node가 node 자리의 서브트리를 그대로 넘겨받음
+  r_node->size = node->size;
+  node->size = node->left->size + node->right->size + 1;
+#endif
 }
 
-static  void R_rotate(rbtree *t, node_t *node)
+static inline void R_rotate(rbtree *t, node_t *node)
 {
   node_t *l_node = node->left;
-  node->left = l_node->right;
+  STORE(node->left, l_node->right);
   if (l_node->right != t->nil)
     l_node->right->parent = node;
   l_node->parent = node->parent;
   if (node->parent == t->nil)
-    t->root = l_node;
+    STORE(t->root, l_node);
   else if (node == node->parent->right)
-    node->parent->right = l_node;
+    STORE(node->parent->right, l_node);
   else
-    node->parent->left = l_node;
+    STORE(node->parent->left, l_node);
   node->parent = l_node;
-  l_node->right = node;
+  STORE(l_node->right, node);
+#ifdef RBTREE_ORDER_STAT
+  l_node->size = node->size;
+  node->size = node->left->size + node->right->size + 1;
+#endif
 }
 
-static void insert_fix_up(rbtree *t, node_t *child)
+//루트가 빨강이 됐다가 검정으로 돌아오면(검정 높이 +1) 1을 돌려줌 (join3이 씀)
+static int insert_fix_up(rbtree *t, node_t *child)
 {
   node_t *uncle;
   while (child != t->root && child->parent->color == RBTREE_RED)
@@ -144,7 +258,9 @@ static void insert_fix_up(rbtree *t, node_t *child)
       }
     }
   }
+  int grew = t->root->color == RBTREE_RED;
   t->root->color = RBTREE_BLACK;
+  return grew;
 }
 
 node_t *rbtree_insert(rbtree *t, const key_t key) {
@@ -158,10 +274,11 @@ node_t *rbtree_insert(rbtree *t, const key_t key) {
   //루트면 root값 만들고 내보내기
   if (t->root == t->nil)
   {
-    t->root = make_node(t, RBTREE_BLACK, key, t->nil);
-    if (!t->root)
+    return_node = make_node(t, RBTREE_BLACK, key, t->nil);
+    if (!return_node)
       return NULL;
-    return t->root;
+    __atomic_store_n(&t->root, return_node, __ATOMIC_RELEASE);
+    return return_node;
   }
   
 
@@ -170,6 +287,10 @@ node_t *rbtree_insert(rbtree *t, const key_t key) {
   while (cur != t->nil)
   {
     parent = cur;
+#ifdef RBTREE_ORDER_STAT
+    //내려가면서 지나는 경로의 크기를 하나씩 늘림 (회전은 L_rotate/R_rotate가 맞춰 줌)
+    cur->size++;
+#endif
     if (cur->key > key)
       cur = cur->left;
     else 
@@ -179,12 +300,20 @@ node_t *rbtree_insert(rbtree *t, const key_t key) {
   //노드만들기
   return_node = make_node(t, RBTREE_RED, key, parent);
   if(!return_node)
+  {
+#ifdef RBTREE_ORDER_STAT
+    for (cur = parent; cur != t->nil; cur = cur->parent)
+      cur->size--;
+#endif
     return NULL;
-  //부모자식찾아주기
+  }
+  //부모자식찾아주기. 락 없이 읽는 쪽(rbtree_conc)이 새 노드를 어느 링크로 처음 보든
+  //(이 release store든 fence 뒤 fix up 회전의 store든) 채워 둔 필드가 먼저 보이도록 함
+  __atomic_thread_fence(__ATOMIC_RELEASE);
   if (parent->key > key)
-    parent->left = return_node;
+    __atomic_store_n(&parent->left, return_node, __ATOMIC_RELEASE);
   else
-    parent->right = return_node;
+    __atomic_store_n(&parent->right, return_node, __ATOMIC_RELEASE);
 
   //최종적으로 fix_up돌리기
   child = return_node;
@@ -233,6 +362,109 @@ node_t *rbtree_max(const rbtree *t) {
     return NULL;
   return result;
 }
+
+//key 이상인 첫 노드. 같은 키가 여럿이면 중위 순서로 맨 앞
+node_t *rbtree_lower_bound(const rbtree *t, const key_t key) {
+  if (!t)
+    return NULL;
+  node_t *cur = t->root, *result = NULL;
+  while (cur != t->nil)
+  {
+    if (cur->key >= key)
+    {
+      result = cur;
+      cur = cur->left;
+    }
+    else
+      cur = cur->right;
+  }
+  return result;
+}
+
+//key보다 큰 첫 노드
+node_t *rbtree_upper_bound(const rbtree *t, const key_t key) {
+  if (!t)
+    return NULL;
+  node_t *cur = t->root, *result = NULL;
+  while (cur != t->nil)
+  {
+    if (cur->key > key)
+    {
+      result = cur;
+      cur = cur->left;
+    }
+    else
+      cur = cur->right;
+  }
+  return result;
+}
+
+//중위 순서 다음 노드: 오른쪽 서브트리의 최소, 없으면 왼쪽 자식으로 올라온 첫 조상.
+//트리 전체를 돌면 간선마다 두 번씩만 지나가니 호출당 amortized O(1)
+node_t *rbtree_next(const rbtree *t, const node_t *p) {
+  if (!t || !p || p == t->nil)
+    return NULL;
+  if (p->right != t->nil)
+  {
+    p = p->right;
+    while (p->left != t->nil)
+      p = p->left;
+    return (node_t *)p;
+  }
+  node_t *parent = p->parent;
+  while (parent != t->nil && p == parent->right)
+  {
+    p = parent;
+    parent = parent->parent;
+  }
+  return parent == t->nil ? NULL : parent;
+}
+
+//중위 순서 이전 노드. rbtree_next의 미러링
+node_t *rbtree_prev(const rbtree *t, const node_t *p) {
+  if (!t || !p || p == t->nil)
+    return NULL;
+  if (p->left != t->nil)
+  {
+    p = p->left;
+    while (p->right != t->nil)
+      p = p->right;
+    return (node_t *)p;
+  }
+  node_t *parent = p->parent;
+  while (parent != t->nil && p == parent->left)
+  {
+    p = parent;
+    parent = parent->parent;
+  }
+  return parent == t->nil ? NULL : parent;
+}
+
+//lo <= key <= hi 인 키를 순서대로 arr에 최대 n개 복사. O(log n + k)
+int rbtree_range(const rbtree *t, const key_t lo, const key_t hi, key_t *arr, const size_t n) {
+  if (!t || !arr)
+    return 0;
+  int count = 0;
+  for (node_t *p = rbtree_lower_bound(t, lo); p && p->key <= hi && count < n; p = rbtree_next(t, p))
+    arr[count++] = p->key;
+  return count;
+}
+
+//lo <= key <= hi 인 노드마다 순서대로 visit 호출. visit이 0이 아닌 값을 돌려주면 멈춤.
+//방문한 노드 수를 돌려줌 (멈춘 노드 포함)
+int rbtree_range_visit(const rbtree *t, const key_t lo, const key_t hi,
+                       int (*visit)(node_t *, void *), void *arg) {
+  if (!t || !visit)
+    return 0;
+  int count = 0;
+  for (node_t *p = rbtree_lower_bound(t, lo); p && p->key <= hi; p = rbtree_next(t, p))
+  {
+    count++;
+    if (visit(p, arg))
+      break;
+  }
+  return count;
+}
 ////////////////////////////////////////////////////////////////////////////////
 
 static void erase_fix_up(rbtree *t, node_t *node)
@@ -314,14 +546,14 @@ static void erase_fix_up(rbtree *t, node_t *node)
   node->color = RBTREE_BLACK;
 }
 
-static void rbtree_transplant(rbtree *t, node_t *u, node_t *v) 
+static inline void rbtree_transplant(rbtree *t, node_t *u, node_t *v) 
 {
   if (u->parent == t->nil)
-    t->root = v;
+    STORE(t->root, v);
   else if (u == u->parent->left)
-    u->parent->left = v;
+    STORE(u->parent->left, v);
   else
-    u->parent->right = v;
+    STORE(u->parent->right, v);
   v->parent = u->parent;
 }
 
@@ -341,6 +573,16 @@ int rbtree_erase(rbtree *t, node_t *p)
   node_t *x;
   color_t y_original_color = y->color; 
 
+#ifdef RBTREE_ORDER_STAT
+  //실제로 빠지는 자리(자식이 둘이면 후계자 자리)부터 루트까지 하나씩 줄임.
+  //형제 서브트리는 건드리지 않으니 경로 위 노드만 읽음
+  node_t *gone = p;
+  if (p->left != t->nil && p->right != t->nil)
+    gone = rbtree_find_successor(t, p->right);
+  for (node_t *cur = gone->parent; cur != t->nil; cur = cur->parent)
+    cur->size--;
+#endif
+
   if (p->left == t->nil)
   {
     x = p->right;
@@ -362,17 +604,20 @@ int rbtree_erase(rbtree *t, node_t *p)
     else 
     {
       rbtree_transplant(t, y, y->right);
-      y->right = p->right;
+      STORE(y->right, p->right);
       y->right->parent = y;
     }
     rbtree_transplant(t, p, y);
-    y->left = p->left;
+    STORE(y->left, p->left);
     y->left->parent = y;
     y->color = p->color;
+#ifdef RBTREE_ORDER_STAT
+    y->size = p->size;
+#endif
   }
   if (y_original_color == RBTREE_BLACK)
     erase_fix_up(t, x);
-  free(p);
+  free_node(t, p);
   return 1;
 }
 ////////////////////////////////////////////////////////////////////////////////
@@ -399,4 +644,707 @@ int rbtree_to_array(const rbtree *t, key_t *arr, const size_t n) {
   inorder_helper(t->root, t->nil, arr, n, &count);
   
   return count;
-}
\ No newline at end of file
+}
+////////////////////////////////////////////////////////////////////////////////
+
+static void release_pool(rbtree *t, node_t *pool)
+{
+  while (pool)
+  {
+    node_t *next = pool->parent;
+    free_node(t, pool);
+    pool = next;
+  }
+}
+
+//pool에 노드 n개를 미리 받아 둠 (parent로 연결). 실패하면 받은 것 돌려주고 0
+static int take_nodes(rbtree *t, size_t n, node_t **pool)
+{
+  for (size_t i = 0; i < n; i++)
+  {
+    node_t *node = alloc_node(t);
+    if (!node)
+    {
+      release_pool(t, *pool);
+      *pool = NULL;
+      return 0;
+    }
+    node->parent = *pool;
+    *pool = node;
+  }
+  return 1;
+}
+
+//기존 트리 노드들을 pool로 옮김 (키는 이미 배열로 빼 둔 상태)
+static void pool_tree_nodes(node_t *node, node_t *nil, node_t **pool)
+{
+  if (node == nil)
+    return;
+  pool_tree_nodes(node->left, nil, pool);
+  pool_tree_nodes(node->right, nil, pool);
+  node->parent = *pool;
+  *pool = node;
+}
+
+#ifndef RBTREE_ORDER_STAT
+static size_t count_nodes(const node_t *node, const node_t *nil)
+{
+  if (node == nil)
+    return 0;
+  return 1 + count_nodes(node->left, nil) + count_nodes(node->right, nil);
+}
+#endif
+
+//정렬된 keys[lo, hi)를 가운데서 나눠 균형 트리로 만듦. 노드는 pool에서 꺼냄.
+//형제 크기 차이가 1 이하라 마지막 레벨만 빼고 꽉 참 →
+//마지막 레벨(red_depth = floor(log2 n))만 빨강이면 모든 경로의 검정 수가 같음
+static node_t *build_balanced(rbtree *t, node_t **pool, const key_t *keys,
+                              size_t lo, size_t hi, int depth, int red_depth,
+                              node_t *parent)
+{
+  if (lo == hi)
+    return t->nil;
+  size_t mid = lo + (hi - lo) / 2;
+  node_t *node = *pool;
+  *pool = node->parent;
+
+  node->key = keys[mid];
+  node->color = depth == red_depth ? RBTREE_RED : RBTREE_BLACK;
+  node->parent = parent;
+#ifdef RBTREE_ORDER_STAT
+  node->size = hi - lo;
+#endif
+  node->left = build_balanced(t, pool, keys, lo, mid, depth + 1, red_depth, node);
+  node->right = build_balanced(t, pool, keys, mid + 1, hi, depth + 1, red_depth, node);
+  return node;
+}
+
+static void build_tree(rbtree *t, node_t **pool, const key_t *keys, size_t n)
+{
+  int red_depth = 0;
+  while (((size_t)2 << red_depth) <= n)
+    red_depth++;
+  t->root = build_balanced(t, pool, keys, 0, n, 0, red_depth, t->nil);
+  t->root->color = RBTREE_BLACK;
+}
+
+rbtree *rbtree_from_sorted_array(const key_t *arr, const size_t n)
+{
+  rbtree *t = new_rbtree();
+  if (!t || n == 0)
+    return t;
+  if (!arr)
+  {
+    delete_rbtree(t);
+    return NULL;
+  }
+
+  node_t *pool = NULL;
+  if (!take_nodes(t, n, &pool))
+  {
+    delete_rbtree(t);
+    return NULL;
+  }
+  build_tree(t, &pool, arr, n);
+  return t;
+}
+
+//key_t(int) 기수 정렬: 8비트씩 4번, 부호 비트는 뒤집어서 음수가 앞으로
+static int sort_keys(key_t *keys, size_t n)
+{
+  key_t *tmp = (key_t *)malloc(n * sizeof(key_t));
+  if (!tmp)
+    return 0;
+  key_t *src = keys, *dst = tmp;
+  for (int shift = 0; shift < 32; shift += 8)
+  {
+    size_t cnt[257] = {0};
+    for (size_t i = 0; i < n; i++)
+      cnt[((((unsigned)src[i] ^ 0x80000000u) >> shift) & 0xff) + 1]++;
+    for (int b = 0; b < 256; b++)
+      cnt[b + 1] += cnt[b];
+    for (size_t i = 0; i < n; i++)
+      dst[cnt[(((unsigned)src[i] ^ 0x80000000u) >> shift) & 0xff]++] = src[i];
+    key_t *swap = src;
+    src = dst;
+    dst = swap;
+  }
+  //짝수 번 돌았으니 결과는 keys에 있음
+  free(tmp);
+  return 1;
+}
+
+//트리 크기의 1/8보다 적게 넣을 때는 하나씩 insert가 다시 짓는 것보다 쌈
+#define BULK_REBUILD_RATIO 8
+
+int rbtree_insert_bulk(rbtree *t, const key_t *arr, const size_t n)
+{
+  //넣은 개수를 int로 돌려주므로 그보다 많으면 받지 않음
+  if (!t || !arr || n == 0 || n > INT_MAX)
+    return 0;
+
+#ifdef RBTREE_ORDER_STAT
+  size_t old = t->root->size;
+#else
+  size_t old = count_nodes(t->root, t->nil);
+#endif
+  key_t *keys = (key_t *)malloc((old + n) * sizeof(key_t));
+  if (!keys)
+    return 0;
+  //새 키는 뒤쪽 n칸에 두고 정렬 (이미 정렬돼 있으면 건너뜀)
+  key_t *add = keys + old;
+  size_t i;
+  for (i = 0; i < n; i++)
+    add[i] = arr[i];
+  for (i = 1; i < n && add[i - 1] <= add[i]; i++)
+    ;
+  if (i < n && !sort_keys(add, n))
+  {
+    free(keys);
+    return 0;
+  }
+
+  if (old / BULK_REBUILD_RATIO > n)
+  {
+    int inserted = 0;
+    for (i = 0; i < n; i++)
+    {
+      if (!rbtree_insert(t, add[i]))
+        break;
+      inserted++;
+    }
+    free(keys);
+    return inserted;
+  }
+
+  //노드를 먼저 다 받아 둬야 중간에 실패해도 트리가 그대로
+  node_t *pool = NULL;
+  if (!take_nodes(t, n, &pool))
+  {
+    free(keys);
+    return 0;
+  }
+
+  //기존 키를 앞에 꺼내고 병합. 같은 키는 기존 것이 앞
+  key_t *merged = (key_t *)malloc((old + n) * sizeof(key_t));
+  if (!merged)
+  {
+    release_pool(t, pool);
+    free(keys);
+    return 0;
+  }
+  rbtree_to_array(t, keys, old);
+  size_t a = 0, b = 0, k = 0;
+  while (a < old && b < n)
+    merged[k++] = add[b] < keys[a] ? add[b++] : keys[a++];
+  while (a < old)
+    merged[k++] = keys[a++];
+  while (b < n)
+    merged[k++] = add[b++];
+
+  pool_tree_nodes(t->root, t->nil, &pool);
+  build_tree(t, &pool, merged, old + n);
+  free(merged);
+  free(keys);
+  return (int)n;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 자르고 잇기. 서브트리는 (루트, 검정 높이) 쌍으로 들고 다니고 루트는 항상 검정.
+// 검정 높이는 nil을 빼고 센 값. 노드는 옮기기만 하고 새로 받지 않으므로
+// 스레드마다 다른 서브트리를 만지는 한 sentinel과 풀은 건드리지 않음
+
+typedef struct {
+  node_t *root;
+  int bh;
+} subtree;
+
+static int black_height(const node_t *node, const node_t *nil)
+{
+  int bh = 0;
+  for (; node != nil; node = node->left)
+    if (node->color == RBTREE_BLACK)
+      bh++;
+  return bh;
+}
+
+//검정 루트의 자식 c(검정 높이 bh)를 떼어 독립 서브트리로. 빨강이면 검정으로 칠하고 높이 +1
+static subtree detach(node_t *nil, node_t *c, int bh)
+{
+  subtree s = {c, bh};
+  if (c != nil)
+  {
+    c->parent = nil;
+    if (c->color == RBTREE_RED)
+    {
+      c->color = RBTREE_BLACK;
+      s.bh++;
+    }
+  }
+  return s;
+}
+
+//l의 키 <= x의 키 <= r의 키일 때 x를 가운데 두고 이음. 검정 높이가 낮은 쪽을
+//높은 쪽 척추에서 같은 높이의 검정 노드 자리에 빨강 x와 함께 끼우고 insert_fix_up.
+//O(|l.bh - r.bh| + 1). 서브트리 크기도 내려가며 지나는 척추 노드만 고침
+static subtree join3(node_t *nil, subtree l, node_t *x, subtree r)
+{
+  subtree s;
+  x->parent = nil;
+  if (l.bh == r.bh)
+  {
+    x->color = RBTREE_BLACK;
+    x->left = l.root;
+    x->right = r.root;
+    if (l.root != nil)
+      l.root->parent = x;
+    if (r.root != nil)
+      r.root->parent = x;
+#ifdef RBTREE_ORDER_STAT
+    x->size = l.root->size + r.root->size + 1;
+#endif
+    s.root = x;
+    s.bh = l.bh + 1;
+    return s;
+  }
+
+  rbtree tmp = {NULL, nil, NULL};
+  node_t *y, *yp = nil;
+  int h;
+  x->color = RBTREE_RED;
+  if (l.bh > r.bh)
+  {
+    tmp.root = l.root;
+    for (y = l.root, h = l.bh; y->color == RBTREE_RED || h > r.bh; y = y->right)
+    {
+      if (y->color == RBTREE_BLACK)
+        h--;
+#ifdef RBTREE_ORDER_STAT
+      //x와 r이 y 아래로 들어감
+      y->size += r.root->size + 1;
+#endif
+      yp = y;
+    }
+    x->left = y;
+    x->right = r.root;
+    yp->right = x;
+    s.bh = l.bh;
+  }
+  else
+  {
+    tmp.root = r.root;
+    for (y = r.root, h = r.bh; y->color == RBTREE_RED || h > l.bh; y = y->left)
+    {
+      if (y->color == RBTREE_BLACK)
+        h--;
+#ifdef RBTREE_ORDER_STAT
+      y->size += l.root->size + 1;
+#endif
+      yp = y;
+    }
+    x->left = l.root;
+    x->right = y;
+    yp->left = x;
+    s.bh = r.bh;
+  }
+  x->parent = yp;
+  if (x->left != nil)
+    x->left->parent = x;
+  if (x->right != nil)
+    x->right->parent = x;
+#ifdef RBTREE_ORDER_STAT
+  //위쪽 척추는 내려가면서 맞췄으니 x만 (fix up의 회전은 L_rotate/R_rotate가 맞춤)
+  x->size = x->left->size + x->right->size + 1;
+#endif
+  s.bh += insert_fix_up(&tmp, x);
+  s.root = tmp.root;
+  return s;
+}
+
+//s를 key 기준으로 둘로: le가 0이면 key 미만 | 이상, 1이면 key 이하 | 초과.
+//경로의 노드마다 join3을 하지만 높이 차의 합이 O(log n)이라 전체도 O(log n)
+static void split_subtree(node_t *nil, subtree s, key_t key, int le,
+                          subtree *l, subtree *r)
+{
+  if (s.root == nil)
+  {
+    *l = *r = s;
+    return;
+  }
+  node_t *x = s.root;
+  subtree a = detach(nil, x->left, s.bh - 1);
+  subtree b = detach(nil, x->right, s.bh - 1);
+  subtree mid;
+  if (x->key < key || (le && x->key == key))
+  {
+    split_subtree(nil, b, key, le, &mid, r);
+    *l = join3(nil, a, x, mid);
+  }
+  else
+  {
+    split_subtree(nil, a, key, le, l, &mid);
+    *r = join3(nil, mid, x, b);
+  }
+}
+
+//맨 오른쪽 노드를 떼어 내고 나머지를 rest로. split과 같은 식으로 O(log n)
+static node_t *split_last(node_t *nil, subtree s, subtree *rest)
+{
+  node_t *x = s.root;
+  subtree a = detach(nil, x->left, s.bh - 1);
+  subtree b = detach(nil, x->right, s.bh - 1);
+  if (b.root == nil)
+  {
+    *rest = a;
+    return x;
+  }
+  subtree mid;
+  node_t *last = split_last(nil, b, &mid);
+  *rest = join3(nil, a, x, mid);
+  return last;
+}
+
+//가운데 노드 없이 잇기: l의 마지막 노드를 가운데로
+static subtree join2(node_t *nil, subtree l, subtree r)
+{
+  if (l.root == nil)
+    return r;
+  if (r.root == nil)
+    return l;
+  subtree rest;
+  node_t *x = split_last(nil, l, &rest);
+  return join3(nil, rest, x, r);
+}
+
+static void relink_nil(node_t *node, node_t *old_nil, node_t *nil)
+{
+  if (node->left == old_nil)
+    node->left = nil;
+  else
+    relink_nil(node->left, old_nil, nil);
+  if (node->right == old_nil)
+    node->right = nil;
+  else
+    relink_nil(node->right, old_nil, nil);
+}
+
+//u의 노드를 t의 풀로 옮김. 노드가 u의 sentinel을 가리키니 O(n)이고,
+//u의 풀을 다른 트리도 쓰고 있으면 chunk를 넘길 수 없어 실패
+static int adopt(rbtree *t, rbtree *u)
+{
+  node_pool *from = u->pool;
+  if (from == t->pool)
+    return 1;
+  if (from->refs != 1)
+    return 0;
+  if (u->root != u->nil)
+  {
+    relink_nil(u->root, u->nil, t->nil);
+    u->root->parent = t->nil;
+  }
+  else
+    u->root = t->nil;
+#ifndef RBTREE_NO_SLAB
+  //t가 잘라 쓰던 맨 앞 chunk는 그대로 두고 u의 chunk를 뒤에 붙임
+  if (!t->pool->chunks)
+  {
+    t->pool->chunks = from->chunks;
+    t->pool->chunk_used = from->chunk_used;
+  }
+  else
+  {
+    //u가 잘라 쓰던 맨 앞 chunk의 남은 자리는 더 잘라 쓸 일이 없으니 free list로
+    node_chunk *head = from->chunks;
+    for (size_t i = from->chunk_used; head && i < head->cap; i++)
+      free_node(t, &head->nodes[i]);
+    node_chunk *c = t->pool->chunks;
+    while (c->next)
+      c = c->next;
+    c->next = from->chunks;
+  }
+  while (from->free_nodes)
+  {
+    node_t *next = from->free_nodes->parent;
+    free_node(t, from->free_nodes);
+    from->free_nodes = next;
+  }
+#endif
+  free(from);
+  u->pool = t->pool;
+  u->pool->refs++;
+  u->nil = t->nil;
+  return 1;
+}
+
+rbtree *rbtree_split(rbtree *t, const key_t key)
+{
+  if (!t)
+    return NULL;
+  rbtree *r = new_rbtree_shared(t);
+  if (!r)
+    return NULL;
+  subtree s = {t->root, black_height(t->root, t->nil)}, a, b;
+  split_subtree(t->nil, s, key, 0, &a, &b);
+  t->root = a.root;
+  r->root = b.root;
+  return r;
+}
+
+int rbtree_join(rbtree *t1, const key_t key, rbtree *t2)
+{
+  if (!t1 || !t2 || t1 == t2)
+    return 0;
+  node_t *hi = rbtree_max(t1), *lo = rbtree_min(t2);
+  if ((hi && hi->key > key) || (lo && lo->key < key))
+    return 0;
+  if (!adopt(t1, t2))
+    return 0;
+  node_t *x = alloc_node(t1);
+  if (!x)
+    return 0;
+  x->key = key;
+  subtree l = {t1->root, black_height(t1->root, t1->nil)};
+  subtree r = {t2->root, black_height(t2->root, t2->nil)};
+  t1->root = join3(t1->nil, l, x, r).root;
+  t2->root = t2->nil;
+  return 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 집합 연산: a의 루트 x로 b를 key 미만 | 같음 | 초과로 자르고, 양쪽을 재귀로 구한 뒤
+// x로 다시 이음 (join 기반 union). 위쪽 fork_depth 단계까지는 왼쪽 재귀를 새 스레드에서.
+// 버릴 노드는 풀이 스레드 안전하지 않으니 목록에 모았다가 끝나고 한꺼번에 반환
+
+enum { SET_UNION, SET_INTERSECTION, SET_DIFFERENCE };
+
+//검정 높이가 이보다 낮은(수백 노드 이하) 조각은 스레드를 만들 가치가 없음
+#define SETOP_FORK_BH 8
+
+typedef struct {
+  node_t *nil;
+  int op;
+  int fork_depth;
+} setop_ctx;
+
+typedef struct {
+  node_t *head, *tail;  // parent로 연결
+} node_list;
+
+typedef struct {
+  const setop_ctx *ctx;
+  subtree a, b, result;
+  int depth;
+  node_list drops;
+} setop_task;
+
+static void drop_node(node_list *list, node_t *node)
+{
+  node->parent = list->head;
+  if (!list->head)
+    list->tail = node;
+  list->head = node;
+}
+
+static void drop_subtree(node_list *list, node_t *node, node_t *nil)
+{
+  if (node == nil)
+    return;
+  drop_subtree(list, node->left, nil);
+  drop_subtree(list, node->right, nil);
+  drop_node(list, node);
+}
+
+static void append_drops(node_list *to, const node_list *from)
+{
+  if (!from->head)
+    return;
+  if (!to->head)
+    to->tail = from->tail;
+  else
+    from->tail->parent = to->head;
+  to->head = from->head;
+}
+
+static void setop_run(setop_task *task);
+
+static void *setop_thread(void *arg)
+{
+  setop_run((setop_task *)arg);
+  return NULL;
+}
+
+static void setop_run(setop_task *task)
+{
+  const setop_ctx *c = task->ctx;
+  node_t *nil = c->nil;
+  subtree a = task->a, b = task->b;
+  subtree empty = {nil, 0};
+
+  if (a.root == nil || b.root == nil)
+  {
+    if (c->op == SET_UNION)
+      task->result = a.root == nil ? b : a;
+    else
+    {
+      task->result = c->op == SET_DIFFERENCE ? a : empty;
+      if (c->op == SET_INTERSECTION)
+        drop_subtree(&task->drops, a.root, nil);
+      drop_subtree(&task->drops, b.root, nil);
+    }
+    return;
+  }
+
+  node_t *x = a.root;
+  const key_t key = x->key;
+  subtree al = detach(nil, x->left, a.bh - 1);
+  subtree ar = detach(nil, x->right, a.bh - 1);
+  subtree b_lt, b_ge, b_eq, b_gt;
+  split_subtree(nil, b, key, 0, &b_lt, &b_ge);
+  split_subtree(nil, b_ge, key, 1, &b_eq, &b_gt);
+  //b의 같은 키는 결과에 안 들어감 (union에서도 a 것이 우선)
+  const int keep = c->op == SET_UNION ||
+                   (b_eq.root != nil) == (c->op == SET_INTERSECTION);
+  drop_subtree(&task->drops, b_eq.root, nil);
+
+  //a에 x와 같은 키가 더 있으면 al의 끝과 ar의 앞에 있음. union은 어차피 다 남기니
+  //그 외 연산에서만 따로 떼어 x와 운명을 같이하게 함
+  subtree a_eq_l = empty, a_eq_r = empty, rest;
+  if (c->op != SET_UNION)
+  {
+    node_t *m;
+    for (m = al.root; m != nil && m->right != nil; m = m->right)
+      ;
+    if (m != nil && m->key == key)
+    {
+      split_subtree(nil, al, key, 0, &rest, &a_eq_l);
+      al = rest;
+    }
+    for (m = ar.root; m != nil && m->left != nil; m = m->left)
+      ;
+    if (m != nil && m->key == key)
+    {
+      split_subtree(nil, ar, key, 1, &a_eq_r, &rest);
+      ar = rest;
+    }
+  }
+
+  setop_task left = {c, al, b_lt, empty, task->depth + 1, {NULL, NULL}};
+  setop_task right = {c, ar, b_gt, empty, task->depth + 1, {NULL, NULL}};
+  pthread_t th;
+  const int forked = task->depth < c->fork_depth &&
+                     (al.bh >= SETOP_FORK_BH || b_lt.bh >= SETOP_FORK_BH) &&
+                     pthread_create(&th, NULL, setop_thread, &left) == 0;
+  if (!forked)
+    setop_run(&left);
+  setop_run(&right);
+  if (forked)
+    pthread_join(th, NULL);
+  append_drops(&task->drops, &left.drops);
+  append_drops(&task->drops, &right.drops);
+
+  if (keep)
+  {
+    subtree l = join2(nil, left.result, a_eq_l);
+    subtree r = join2(nil, a_eq_r, right.result);
+    task->result = join3(nil, l, x, r);
+  }
+  else
+  {
+    drop_subtree(&task->drops, a_eq_l.root, nil);
+    drop_subtree(&task->drops, a_eq_r.root, nil);
+    drop_node(&task->drops, x);
+    task->result = join2(nil, left.result, right.result);
+  }
+}
+
+static int set_operation(rbtree *t1, rbtree *t2, int op, int threads)
+{
+  if (!t1 || !t2 || t1 == t2 || !adopt(t1, t2))
+    return 0;
+  if (threads <= 0)
+  {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = cpus > 0 ? (int)cpus : 1;
+  }
+  setop_ctx c = {t1->nil, op, 0};
+  while ((1 << c.fork_depth) < threads)
+    c.fork_depth++;
+
+  setop_task task = {&c, {t1->root, black_height(t1->root, t1->nil)},
+                     {t2->root, black_height(t2->root, t2->nil)},
+                     {t1->nil, 0}, 0, {NULL, NULL}};
+  setop_run(&task);
+  t1->root = task.result.root;
+  t2->root = t2->nil;
+  for (node_t *p = task.drops.head, *next; p; p = next)
+  {
+    next = p->parent;
+    free_node(t1, p);
+  }
+  return 1;
+}
+
+int rbtree_union(rbtree *t1, rbtree *t2, int threads)
+{
+  return set_operation(t1, t2, SET_UNION, threads);
+}
+
+int rbtree_intersection(rbtree *t1, rbtree *t2, int threads)
+{
+  return set_operation(t1, t2, SET_INTERSECTION, threads);
+}
+
+int rbtree_difference(rbtree *t1, rbtree *t2, int threads)
+{
+  return set_operation(t1, t2, SET_DIFFERENCE, threads);
+}
+
+#ifdef RBTREE_ORDER_STAT
+////////////////////////////////////////////////////////////////////////////////
+
+size_t rbtree_size(const rbtree *t) {
+  if (!t)
+    return 0;
+  return t->root->size;
+}
+
+//k번째로 작은 노드 (0부터). 왼쪽 서브트리 크기로 방향을 정함. O(log n)
+node_t *rbtree_select(const rbtree *t, size_t k) {
+  if (!t)
+    return NULL;
+  node_t *cur = t->root;
+  while (cur != t->nil)
+  {
+    size_t left = cur->left->size;
+    if (k < left)
+      cur = cur->left;
+    else if (k == left)
+      return cur;
+    else
+    {
+      k -= left + 1;
+      cur = cur->right;
+    }
+  }
+  return NULL;
+}
+
+//key보다 작은 키의 개수 = rbtree_lower_bound 노드의 순위. O(log n)
+size_t rbtree_rank(const rbtree *t, const key_t key) {
+  if (!t)
+    return 0;
+  size_t rank = 0;
+  node_t *cur = t->root;
+  while (cur != t->nil)
+  {
+    if (cur->key >= key)
+      cur = cur->left;
+    else
+    {
+      rank += cur->left->size + 1;
+      cur = cur->right;
+    }
+  }
+  return rank;
+}
+#endif
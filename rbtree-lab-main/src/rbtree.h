@@ -11,14 +11,39 @@ typedef struct node_t {
   color_t color;
   key_t key;
   struct node_t *parent, *left, *right;
+#ifdef RBTREE_ORDER_STAT
+  size_t size;  // 이 노드를 루트로 하는 서브트리의 노드 수 (nil은 0)
+#endif
 } node_t;
 
+// 노드 slab: 노드를 큰 덩어리(chunk)로 잘라 쓰고, delete_rbtree에서 한 번에 반환
+typedef struct node_chunk {
+  struct node_chunk *next;
+  size_t cap;
+  node_t nodes[];
+} node_chunk;
+
+// 노드 풀: sentinel과 slab. split/join은 노드를 트리 사이로 옮기기만 하므로
+// 그렇게 엮인 트리들은 풀 하나를 같이 쓰고, 마지막 트리가 지워질 때 chunk를 반환.
+// 풀을 같이 쓰는 트리들(rbtree_split, new_rbtree_shared로 만든 트리)은 erase가 쓰는
+// sentinel, free list, refs(atomic 아님)를 같이 고치므로, 고치기와 delete_rbtree를
+// 서로 다른 스레드에서 동시에 하면 안 됨. 따로 만든 트리끼리는 상관없음
+typedef struct {
+  node_t nil;          // 풀을 쓰는 트리들의 sentinel
+  node_chunk *chunks;  // 할당받은 chunk 목록 (맨 앞이 지금 잘라 쓰는 chunk)
+  size_t chunk_used;   // 맨 앞 chunk에서 이미 잘라 준 노드 수
+  node_t *free_nodes;  // erase된 노드들 (parent로 연결)
+  int refs;            // 이 풀을 쓰는 트리 수
+} node_pool;
+
 typedef struct {
   node_t *root;
-  node_t *nil;  // for sentinel
+  node_t *nil;  // for sentinel (&pool->nil)
+  node_pool *pool;
 } rbtree;
 
 rbtree *new_rbtree(void);
+rbtree *new_rbtree_shared(rbtree *);  // 주어진 트리와 노드 풀을 같이 쓰는 빈 트리
 void delete_rbtree(rbtree *);
 
 node_t *rbtree_insert(rbtree *, const key_t);
@@ -27,6 +52,44 @@ node_t *rbtree_min(const rbtree *);
 node_t *rbtree_max(const rbtree *);
 int rbtree_erase(rbtree *, node_t *);
 
+// 순회와 범위 질의. 끝에 닿으면 NULL
+node_t *rbtree_lower_bound(const rbtree *, const key_t);  // key 이상인 첫 노드
+node_t *rbtree_upper_bound(const rbtree *, const key_t);  // key보다 큰 첫 노드
+node_t *rbtree_next(const rbtree *, const node_t *);
+node_t *rbtree_prev(const rbtree *, const node_t *);
+// [lo, hi] 구간의 키를 순서대로 최대 n개 복사, 복사한 개수를 돌려줌
+int rbtree_range(const rbtree *, const key_t, const key_t, key_t *, const size_t);
+// [lo, hi] 구간의 노드마다 visit 호출, 0이 아닌 값을 돌려주면 멈춤
+int rbtree_range_visit(const rbtree *, const key_t, const key_t,
+                       int (*)(node_t *, void *), void *);
+
 int rbtree_to_array(const rbtree *, key_t *, const size_t);
 
+// arr은 오름차순이어야 함. O(n)으로 균형 트리를 만들어 돌려줌 (실패 시 NULL)
+rbtree *rbtree_from_sorted_array(const key_t *, const size_t);
+// 정렬 안 된 키 n개를 한꺼번에 추가. 넣은 개수를 돌려줌 (실패 시 0, n > INT_MAX도 실패)
+int rbtree_insert_bulk(rbtree *, const key_t *, const size_t);
+
+// 자르고 잇기. 풀을 같이 쓰는 트리끼리는 O(log n).
+// 풀이 다른 트리는 그 풀을 혼자 쓸 때만 O(n)으로 옮겨 와서 잇고, 아니면 실패
+// key 이상인 키를 새 트리(같은 풀)로 떼어 내 돌려줌, t에는 key 미만이 남음 (실패 시 NULL)
+rbtree *rbtree_split(rbtree *, const key_t);
+// t1의 키 <= key <= t2의 키일 때 t1 뒤에 key와 t2를 이어 붙임. t2는 빈 트리가 됨 (1 성공, 0 실패)
+int rbtree_join(rbtree *, const key_t, rbtree *);
+
+// 집합 연산: 결과는 t1에 남고 t2는 빈 트리가 됨 (노드는 옮기거나 풀에 반환, 새로 받지 않음).
+// 결과 노드는 t1의 것이 우선: union은 t1에 없는 키만 t2에서 가져오고,
+// intersection/difference는 키가 t2에 있는/없는 t1 노드만 남김.
+// join 기반 fork-join 재귀로, threads개(0이면 CPU 수)까지 나눠 돌림 (1 성공, 0 실패)
+int rbtree_union(rbtree *, rbtree *, int);
+int rbtree_intersection(rbtree *, rbtree *, int);
+int rbtree_difference(rbtree *, rbtree *, int);
+
+#ifdef RBTREE_ORDER_STAT
+// 순서 통계 (-DRBTREE_ORDER_STAT로 빌드할 때만). 모두 O(log n), size는 O(1)
+size_t rbtree_size(const rbtree *);
+node_t *rbtree_select(const rbtree *, size_t);    // k번째로 작은 노드 (0부터), 없으면 NULL
+size_t rbtree_rank(const rbtree *, const key_t);  // key보다 작은 키의 개수
+#endif
+
 #endif  // _RBTREE_H_
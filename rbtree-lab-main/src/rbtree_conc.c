@@ -0,0 +1,141 @@
+#include "rbtree_conc.h"
+#include <stdlib.h>
+
+#ifdef RBTREE_NO_SLAB
+#error "rbtree_conc needs the node slab: lock-free readers may touch erased nodes"
+#endif
+
+//읽기가 이만큼 연달아 실패하면(쓰기가 몰릴 때) 락을 잡고 읽음
+#define CONC_READ_RETRIES 8
+//높이는 2 log2(n + 1)을 넘지 않음. 더 내려가면 쓰기 중간 상태를 본 것이니 다시 읽음
+#define CONC_MAX_DEPTH 128
+
+//쓰기와 겹쳐 읽는 필드는 atomic load로 (찢어진 값을 읽지 않게, 컴파일러가 다시 읽지 않게)
+#define LOAD(p) __atomic_load_n(&(p), __ATOMIC_RELAXED)
+//따라갈 링크는 consume으로: rbtree_insert가 새 노드를 release로 (회전은 fence 뒤 atomic store로)
+//이으니 ARM/POWER에서도 링크로 본 노드의 필드는 채워진 값으로 보임 (x86에서는 보통 load).
+//쓰기 쪽도 이 필드들을 atomic store로 씀 (rbtree.c의 STORE)
+#define FOLLOW(p) __atomic_load_n(&(p), __ATOMIC_CONSUME)
+
+rbtree_conc *new_rbtree_conc(void) {
+  rbtree_conc *c = (rbtree_conc *)calloc(1, sizeof(rbtree_conc));
+  if (!c)
+    return NULL;
+  c->tree = new_rbtree();
+  if (!c->tree)
+  {
+    free(c);
+    return NULL;
+  }
+  pthread_mutex_init(&c->lock, NULL);
+  return c;
+}
+
+void delete_rbtree_conc(rbtree_conc *c) {
+  if (!c)
+    return;
+  pthread_mutex_destroy(&c->lock);
+  delete_rbtree(c->tree);
+  free(c);
+}
+
+//seq를 홀수로 만든 뒤 고치고, 다 고친 다음 짝수로 (release라 고친 내용이 먼저 보임)
+static void write_begin(rbtree_conc *c)
+{
+  pthread_mutex_lock(&c->lock);
+  __atomic_store_n(&c->seq, c->seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void write_end(rbtree_conc *c)
+{
+  __atomic_store_n(&c->seq, c->seq + 1, __ATOMIC_RELEASE);
+  pthread_mutex_unlock(&c->lock);
+}
+
+int rbtree_conc_insert(rbtree_conc *c, const key_t key) {
+  if (!c)
+    return 0;
+  write_begin(c);
+  node_t *p = rbtree_insert(c->tree, key);
+  write_end(c);
+  return p != NULL;
+}
+
+int rbtree_conc_erase(rbtree_conc *c, const key_t key) {
+  if (!c)
+    return 0;
+  write_begin(c);
+  node_t *p = rbtree_find(c->tree, key);
+  if (p)
+    rbtree_erase(c->tree, p);
+  write_end(c);
+  return p != NULL;
+}
+
+//락 없이 key 이상인 첫 키를 찾음 (같은 키를 만나면 바로 끝).
+//도중에 쓰기가 있었으면 -1, 아니면 찾았는지(1/0)
+static int try_lower_bound(rbtree_conc *c, key_t key, key_t *out)
+{
+  unsigned long seq = __atomic_load_n(&c->seq, __ATOMIC_ACQUIRE);
+  if (seq & 1)
+    return -1;
+
+  node_t *nil = c->tree->nil;
+  node_t *cur = FOLLOW(c->tree->root);
+  key_t best = 0;
+  int found = 0, depth = 0;
+  while (cur != nil)
+  {
+    if (++depth > CONC_MAX_DEPTH)
+      return -1;
+    key_t k = LOAD(cur->key);
+    if (k >= key)
+    {
+      best = k;
+      found = 1;
+      if (k == key)
+        break;
+      cur = FOLLOW(cur->left);
+    }
+    else
+      cur = FOLLOW(cur->right);
+  }
+
+  //읽은 내용이 seq 재확인보다 먼저 끝나도록
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  if (__atomic_load_n(&c->seq, __ATOMIC_RELAXED) != seq)
+    return -1;
+  *out = best;
+  return found;
+}
+
+static int read_lower_bound(rbtree_conc *c, key_t key, key_t *out)
+{
+  for (int i = 0; i < CONC_READ_RETRIES; i++)
+  {
+    int r = try_lower_bound(c, key, out);
+    if (r >= 0)
+      return r;
+  }
+  //쓰기에 계속 밀리면 락을 잡고 읽음
+  pthread_mutex_lock(&c->lock);
+  node_t *p = rbtree_lower_bound(c->tree, key);
+  if (p)
+    *out = p->key;
+  pthread_mutex_unlock(&c->lock);
+  return p != NULL;
+}
+
+int rbtree_conc_find(rbtree_conc *c, const key_t key) {
+  key_t k;
+  if (!c)
+    return 0;
+  return read_lower_bound(c, key, &k) && k == key;
+}
+
+int rbtree_conc_lower_bound(rbtree_conc *c, const key_t key, key_t *out) {
+  if (!c || !out)
+    return 0;
+  return read_lower_bound(c, key, out);
+}
@@ -0,0 +1,34 @@
+#ifndef _RBTREE_CONC_H_
+#define _RBTREE_CONC_H_
+
+#include "rbtree.h"
+#include <pthread.h>
+
+// 읽기가 대부분인 곳에서 여러 스레드가 같이 쓰는 rbtree.
+// 쓰기(insert/erase)는 mutex로 줄을 세우고, 읽기는 락 없이 트리를 내려간 뒤
+// seqlock 카운터로 그동안 쓰기가 없었는지 확인해서 있었으면 다시 읽습니다.
+// 지운 노드는 slab의 free list로만 가고 delete 때까지 메모리가 반환되지 않으므로
+// 쓰기와 겹친 읽기가 엉뚱한 노드를 따라가도 안전합니다 (그래서 RBTREE_NO_SLAB 빌드는 안 됨).
+// 쓰기는 같이 읽는 필드(root, left, right, key)를 atomic store로 쓰고 새 노드를 release로
+// 이으며, 읽기는 링크를 consume으로 따라가므로, x86뿐 아니라 ARM/POWER처럼 순서가 약한
+// CPU에서도 채우기 전의 노드를 보지 않습니다.
+// 읽기는 노드 포인터 대신 키 복사본을 돌려줍니다 (돌려준 직후 지워질 수 있으므로).
+
+typedef struct {
+  rbtree *tree;
+  unsigned long seq;     // 홀수면 쓰는 중
+  pthread_mutex_t lock;  // 쓰기끼리, 그리고 계속 실패한 읽기가 잡음
+} rbtree_conc;
+
+rbtree_conc *new_rbtree_conc(void);
+void delete_rbtree_conc(rbtree_conc *);
+
+int rbtree_conc_insert(rbtree_conc *, const key_t);  // 1 성공, 0 메모리 부족
+int rbtree_conc_erase(rbtree_conc *, const key_t);   // key 하나를 지움, 없으면 0
+
+// 락 없이 읽기. 있으면 1
+int rbtree_conc_find(rbtree_conc *, const key_t);
+// key 이상인 첫 키를 *out에 복사, 없으면 0
+int rbtree_conc_lower_bound(rbtree_conc *, const key_t, key_t *);
+
+#endif  // _RBTREE_CONC_H_
@@ -0,0 +1,754 @@
+#ifndef _RBTREE_GEN_H_
+#define _RBTREE_GEN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 키/값 타입과 비교 매크로마다 찍어내는 rbtree.
+//
+//   RBTREE_DEFINE(이름, 키 타입, 값 타입, 비교 매크로)
+//   RBTREE_DEFINE_COMPACT(이름, 키 타입, 값 타입, 비교 매크로)
+//
+// 이름_tree, 이름_node 타입과 이름_new, _delete, _insert(multiset),
+// _put(map: 같은 키면 값만 바꿈), _find, _erase, _min, _max, _next, _prev,
+// _lower_bound, _upper_bound 함수가 static inline으로 생깁니다.
+// 비교 매크로 cmp(a, b)는 a < b면 음수, 같으면 0, a > b면 양수.
+// 함수 포인터를 거치지 않고 그 자리에 펼쳐지므로 키 타입마다 따로 최적화됨.
+// 알고리즘과 노드 slab은 rbtree.c와 같고, 키/값은 노드 안에 값으로 들어갑니다
+// (문자열 키는 포인터만 저장하니 문자열은 트리보다 오래 살아 있어야 함).
+// 못 찾으면 NULL, 할당 실패 시 _new/_insert/_put은 NULL.
+//
+// COMPACT는 색을 부모 포인터의 최하위 비트에 넣고 sentinel 대신 NULL 자식을
+// 씁니다. 색 필드와 그 패딩이 빠져 int/int 노드가 40에서 32바이트로 줄어요
+// (LP64). 색과 부모는 이름_parent, 이름_is_red로 읽습니다.
+//
+// int 키 API(rbtree.h)는 rbtree.c 그대로 유지합니다. 같은 알고리즘의
+// (key_t, 값 없음) 버전이고, 순서 통계와 bulk 빌드는 그쪽에만 있습니다.
+
+#define RBTREE_CMP_NUM(a, b) (((a) > (b)) - ((a) < (b)))
+#define RBTREE_CMP_STR(a, b) strcmp((a), (b))
+
+#define RBTREE_GEN_CHUNK_MIN 64
+#define RBTREE_GEN_CHUNK_MAX 4096
+
+// 노드 slab: 트리마다 chunk를 잘라 쓰고 지운 노드는 LINK 필드로 free list에
+#define RBTREE_GEN_SLAB_(P, LINK)                                             \
+typedef struct P##_chunk {                                                    \
+  struct P##_chunk *next;                                                     \
+  size_t cap;                                                                 \
+  P##_node nodes[];                                                           \
+} P##_chunk;                                                                  \
+                                                                              \
+static inline void P##_delete(P##_tree *t) {                                  \
+  if (!t)                                                                     \
+    return;                                                                   \
+  P##_chunk *c = t->chunks;                                                   \
+  while (c) {                                                                 \
+    P##_chunk *next = c->next;                                                \
+    free(c);                                                                  \
+    c = next;                                                                 \
+  }                                                                           \
+  free(t);                                                                    \
+}                                                                             \
+                                                                              \
+static inline P##_node *P##_alloc_node(P##_tree *t) {                         \
+  P##_node *node = t->free_nodes;                                             \
+  if (node) {                                                                 \
+    t->free_nodes = node->LINK;                                               \
+    return node;                                                              \
+  }                                                                           \
+  P##_chunk *c = t->chunks;                                                   \
+  if (!c || t->chunk_used == c->cap) {                                        \
+    size_t cap = c ? c->cap * 2 : RBTREE_GEN_CHUNK_MIN;                       \
+    if (cap > RBTREE_GEN_CHUNK_MAX)                                           \
+      cap = RBTREE_GEN_CHUNK_MAX;                                             \
+    c = (P##_chunk *)malloc(sizeof(P##_chunk) + cap * sizeof(P##_node));      \
+    if (!c)                                                                   \
+      return NULL;                                                            \
+    c->cap = cap;                                                             \
+    c->next = t->chunks;                                                      \
+    t->chunks = c;                                                            \
+    t->chunk_used = 0;                                                        \
+  }                                                                           \
+  return &c->nodes[t->chunk_used++];                                          \
+}                                                                             \
+                                                                              \
+static inline void P##_free_node(P##_tree *t, P##_node *node) {               \
+  node->LINK = t->free_nodes;                                                 \
+  t->free_nodes = node;                                                       \
+}
+
+#define RBTREE_DEFINE(P, K, V, CMP)                                           \
+typedef struct P##_node {                                                     \
+  K key;                                                                      \
+  V value;                                                                    \
+  struct P##_node *parent, *left, *right;                                     \
+  unsigned char red;                                                          \
+} P##_node;                                                                   \
+                                                                              \
+typedef struct {                                                              \
+  P##_node *root;                                                             \
+  P##_node *nil;                                                              \
+  P##_node nil_node;  /* sentinel은 트리 구조체 안에 둠 */                             \
+  struct P##_chunk *chunks;                                                   \
+  size_t chunk_used;                                                          \
+  P##_node *free_nodes;                                                       \
+} P##_tree;                                                                   \
+                                                                              \
+RBTREE_GEN_SLAB_(P, parent)                                                   \
+                                                                              \
+static inline P##_tree *P##_new(void) {                                       \
+  P##_tree *t = (P##_tree *)calloc(1, sizeof(P##_tree));                      \
+  if (!t)                                                                     \
+    return NULL;                                                              \
+  t->nil = &t->nil_node;                                                      \
+  t->nil->parent = t->nil->left = t->nil->right = t->nil;                     \
+  t->root = t->nil;                                                           \
+  return t;                                                                   \
+}                                                                             \
+                                                                              \
+static inline void P##_rotate_left(P##_tree *t, P##_node *node) {             \
+  P##_node *r = node->right;                                                  \
+  node->right = r->left;                                                      \
+  if (r->left != t->nil)                                                      \
+    r->left->parent = node;                                                   \
+  r->parent = node->parent;                                                   \
+  if (node->parent == t->nil)                                                 \
+    t->root = r;                                                              \
+  else if (node == node->parent->left)                                        \
+    node->parent->left = r;                                                   \
+  else                                                                        \
+    node->parent->right = r;                                                  \
+  r->left = node;                                                             \
+  node->parent = r;                                                           \
+}                                                                             \
+                                                                              \
+static inline void P##_rotate_right(P##_tree *t, P##_node *node) {            \
+  P##_node *l = node->left;                                                   \
+  node->left = l->right;                                                      \
+  if (l->right != t->nil)                                                     \
+    l->right->parent = node;                                                  \
+  l->parent = node->parent;                                                   \
+  if (node->parent == t->nil)                                                 \
+    t->root = l;                                                              \
+  else if (node == node->parent->right)                                       \
+    node->parent->right = l;                                                  \
+  else                                                                        \
+    node->parent->left = l;                                                   \
+  l->right = node;                                                            \
+  node->parent = l;                                                           \
+}                                                                             \
+                                                                              \
+/* 새 노드를 parent의 왼쪽/오른쪽에 달고 색을 맞춤 (rbtree.c의 insert_fix_up) */                \
+static inline P##_node *P##_link(P##_tree *t, P##_node *parent, int left,     \
+                                 K key, V value) {                            \
+  P##_node *node = P##_alloc_node(t);                                         \
+  if (!node)                                                                  \
+    return NULL;                                                              \
+  node->key = key;                                                            \
+  node->value = value;                                                        \
+  node->parent = parent;                                                      \
+  node->left = node->right = t->nil;                                          \
+  node->red = 1;                                                              \
+  if (parent == t->nil)                                                       \
+    t->root = node;                                                           \
+  else if (left)                                                              \
+    parent->left = node;                                                      \
+  else                                                                        \
+    parent->right = node;                                                     \
+                                                                              \
+  P##_node *x = node;                                                         \
+  while (x->parent->red) {                                                    \
+    P##_node *g = x->parent->parent;                                          \
+    if (x->parent == g->left) {                                               \
+      P##_node *u = g->right;                                                 \
+      if (u->red) {                                                           \
+        x->parent->red = u->red = 0;                                          \
+        g->red = 1;                                                           \
+        x = g;                                                                \
+      } else {                                                                \
+        if (x == x->parent->right) {                                          \
+          x = x->parent;                                                      \
+          P##_rotate_left(t, x);                                              \
+        }                                                                     \
+        x->parent->red = 0;                                                   \
+        x->parent->parent->red = 1;                                           \
+        P##_rotate_right(t, x->parent->parent);                               \
+      }                                                                       \
+    } else {                                                                  \
+      P##_node *u = g->left;                                                  \
+      if (u->red) {                                                           \
+        x->parent->red = u->red = 0;                                          \
+        g->red = 1;                                                           \
+        x = g;                                                                \
+      } else {                                                                \
+        if (x == x->parent->left) {                                           \
+          x = x->parent;                                                      \
+          P##_rotate_right(t, x);                                             \
+        }                                                                     \
+        x->parent->red = 0;                                                   \
+        x->parent->parent->red = 1;                                           \
+        P##_rotate_left(t, x->parent->parent);                                \
+      }                                                                       \
+    }                                                                         \
+  }                                                                           \
+  t->root->red = 0;                                                           \
+  return node;                                                                \
+}                                                                             \
+                                                                              \
+/* multiset 삽입: 같은 키가 있어도 하나 더 (rbtree_insert와 같음) */                         \
+static inline P##_node *P##_insert(P##_tree *t, K key, V value) {             \
+  P##_node *parent = t->nil, *cur = t->root;                                  \
+  int left = 0;                                                               \
+  while (cur != t->nil) {                                                     \
+    parent = cur;                                                             \
+    left = CMP(cur->key, key) > 0;                                            \
+    cur = left ? cur->left : cur->right;                                      \
+  }                                                                           \
+  return P##_link(t, parent, left, key, value);                               \
+}                                                                             \
+                                                                              \
+/* map 삽입: 같은 키가 있으면 값만 바꿈 */                                                 \
+static inline P##_node *P##_put(P##_tree *t, K key, V value) {                \
+  P##_node *parent = t->nil, *cur = t->root;                                  \
+  int left = 0;                                                               \
+  while (cur != t->nil) {                                                     \
+    int c = CMP(cur->key, key);                                               \
+    if (c == 0) {                                                             \
+      cur->value = value;                                                     \
+      return cur;                                                             \
+    }                                                                         \
+    parent = cur;                                                             \
+    left = c > 0;                                                             \
+    cur = left ? cur->left : cur->right;                                      \
+  }                                                                           \
+  return P##_link(t, parent, left, key, value);                               \
+}                                                                             \
+                                                                              \
+static inline P##_node *P##_find(const P##_tree *t, K key) {                  \
+  P##_node *cur = t->root;                                                    \
+  while (cur != t->nil) {                                                     \
+    int c = CMP(cur->key, key);                                               \
+    if (c == 0)                                                               \
+      return cur;                                                             \
+    cur = c > 0 ? cur->left : cur->right;                                     \
+  }                                                                           \
+  return NULL;                                                                \
+}                                                                             \
+                                                                              \
+static inline P##_node *P##_lower_bound(const P##_tree *t, K key) {           \
+  P##_node *cur = t->root, *result = NULL;                                    \
+  while (cur != t->nil) {                                                     \
+    if (CMP(cur->key, key) >= 0) {                                            \
+      result = cur;                                                           \
+      cur = cur->left;                                                        \
+    } else                                                                    \
+      cur = cur->right;                                                       \
+  }                                                                           \
+  return result;                                                              \
+}                                                                             \
+                                                                              \
+static inline P##_node *P##_upper_bound(const P##_tree *t, K key) {           \
+  P##_node *cur = t->root, *result = NULL;                                    \
+  while (cur != t->nil) {                                                     \
+    if (CMP(cur->key, key) > 0) {                                             \
+      result = cur;                                                           \
+      cur = cur->left;                                                        \
+    } else                                                                    \
+      cur = cur->right;                                                       \
+  }                                                                           \
+  return result;                                                              \
+}                                                                             \
+                                                                              \
+static inline P##_node *P##_min(const P##_tree *t) {                          \
+  P##_node *cur = t->root;                                                    \
+  if (cur == t->nil)                                                          \
+    return NULL;                                                              \
+  while (cur->left != t->nil)                                                 \
+    cur = cur->left;                                                          \
+  return cur;                                                                 \
+}                                                                             \
+                                                                              \
+static inline P##_node *P##_max(const P##_tree *t) {                          \
+  P##_node *cur = t->root;                                                    \
+  if (cur == t->nil)                                                          \
+    return NULL;                                                              \
+  while (cur->right != t->nil)                                                \
+    cur = cur->right;                                                         \
+  return cur;                                                                 \
+}                                                                             \
+                                                                              \
+static inline P##_node *P##_next(const P##_tree *t, P##_node *p) {            \
+  if (p->right != t->nil) {                                                   \
+    p = p->right;                                                             \
+    while (p->left != t->nil)                                                 \
+      p = p->left;                                                            \
+    return p;                                                                 \
+  }                                                                           \
+  while (p->parent != t->nil && p == p->parent->right)                        \
+    p = p->parent;                                                            \
+  return p->parent == t->nil ? NULL : p->parent;                              \
+}                                                                             \
+                                                                              \
+static inline P##_node *P##_prev(const P##_tree *t, P##_node *p) {            \
+  if (p->left != t->nil) {                                                    \
+    p = p->left;                                                              \
+    while (p->right != t->nil)                                                \
+      p = p->right;                                                           \
+    return p;                                                                 \
+  }                                                                           \
+  while (p->parent != t->nil && p == p->parent->left)                         \
+    p = p->parent;                                                            \
+  return p->parent == t->nil ? NULL : p->parent;                              \
+}                                                                             \
+                                                                              \
+static inline void P##_transplant(P##_tree *t, P##_node *u, P##_node *v) {    \
+  if (u->parent == t->nil)                                                    \
+    t->root = v;                                                              \
+  else if (u == u->parent->left)                                              \
+    u->parent->left = v;                                                      \
+  else                                                                        \
+    u->parent->right = v;                                                     \
+  v->parent = u->parent;                                                      \
+}                                                                             \
+                                                                              \
+static inline void P##_erase_fix_up(P##_tree *t, P##_node *x) {               \
+  while (x != t->root && !x->red) {                                           \
+    if (x == x->parent->left) {                                               \
+      P##_node *w = x->parent->right;                                         \
+      if (w->red) {                                                           \
+        w->red = 0;                                                           \
+        x->parent->red = 1;                                                   \
+        P##_rotate_left(t, x->parent);                                        \
+        w = x->parent->right;                                                 \
+      }                                                                       \
+      if (!w->left->red && !w->right->red) {                                  \
+        w->red = 1;                                                           \
+        x = x->parent;                                                        \
+      } else {                                                                \
+        if (!w->right->red) {                                                 \
+          w->left->red = 0;                                                   \
+          w->red = 1;                                                         \
+          P##_rotate_right(t, w);                                             \
+          w = x->parent->right;                                               \
+        }                                                                     \
+        w->red = x->parent->red;                                              \
+        x->parent->red = 0;                                                   \
+        w->right->red = 0;                                                    \
+        P##_rotate_left(t, x->parent);                                        \
+        x = t->root;                                                          \
+      }                                                                       \
+    } else {                                                                  \
+      P##_node *w = x->parent->left;                                          \
+      if (w->red) {                                                           \
+        w->red = 0;                                                           \
+        x->parent->red = 1;                                                   \
+        P##_rotate_right(t, x->parent);                                       \
+        w = x->parent->left;                                                  \
+      }                                                                       \
+      if (!w->left->red && !w->right->red) {                                  \
+        w->red = 1;                                                           \
+        x = x->parent;                                                        \
+      } else {                                                                \
+        if (!w->left->red) {                                                  \
+          w->right->red = 0;                                                  \
+          w->red = 1;                                                         \
+          P##_rotate_left(t, w);                                              \
+          w = x->parent->left;                                                \
+        }                                                                     \
+        w->red = x->parent->red;                                              \
+        x->parent->red = 0;                                                   \
+        w->left->red = 0;                                                     \
+        P##_rotate_right(t, x->parent);                                       \
+        x = t->root;                                                          \
+      }                                                                       \
+    }                                                                         \
+  }                                                                           \
+  x->red = 0;                                                                 \
+}                                                                             \
+                                                                              \
+/* p를 빼고 노드는 free list로 (rbtree_erase와 같음) */                                 \
+static inline int P##_erase(P##_tree *t, P##_node *p) {                       \
+  if (!p || p == t->nil)                                                      \
+    return 0;                                                                 \
+  P##_node *x, *y = p;                                                        \
+  int y_red = y->red;                                                         \
+  if (p->left == t->nil) {                                                    \
+    x = p->right;                                                             \
+    P##_transplant(t, p, p->right);                                           \
+  } else if (p->right == t->nil) {                                            \
+    x = p->left;                                                              \
+    P##_transplant(t, p, p->left);                                            \
+  } else {                                                                    \
+    y = p->right;                                                             \
+    while (y->left != t->nil)                                                 \
+      y = y->left;                                                            \
+    y_red = y->red;                                                           \
+    x = y->right;                                                             \
+    if (y->parent == p)                                                       \
+      x->parent = y;                                                          \
+    else {                                                                    \
+      P##_transplant(t, y, y->right);                                         \
+      y->right = p->right;                                                    \
+      y->right->parent = y;                                                   \
+    }                                                                         \
+    P##_transplant(t, p, y);                                                  \
+    y->left = p->left;                                                        \
+    y->left->parent = y;                                                      \
+    y->red = p->red;                                                          \
+  }                                                                           \
+  if (!y_red)                                                                 \
+    P##_erase_fix_up(t, x);                                                   \
+  P##_free_node(t, p);                                                        \
+  return 1;                                                                   \
+}
+
+#define RBTREE_DEFINE_COMPACT(P, K, V, CMP)                                   \
+typedef struct P##_node {                                                     \
+  K key;                                                                      \
+  V value;                                                                    \
+  uintptr_t parent_red;  /* 부모 포인터 | 빨강이면 1 (노드는 2바이트 이상 정렬) */               \
+  struct P##_node *left, *right;                                              \
+} P##_node;                                                                   \
+                                                                              \
+typedef struct {                                                              \
+  P##_node *root;  /* sentinel 없음: 빈 자식은 NULL */                              \
+  struct P##_chunk *chunks;                                                   \
+  size_t chunk_used;                                                          \
+  P##_node *free_nodes;                                                       \
+} P##_tree;                                                                   \
+                                                                              \
+RBTREE_GEN_SLAB_(P, left)                                                     \
+                                                                              \
+static inline P##_node *P##_parent(const P##_node *n) {                       \
+  return (P##_node *)(n->parent_red & ~(uintptr_t)1);                         \
+}                                                                             \
+                                                                              \
+/* NULL 자식은 검정 */                                                             \
+static inline int P##_is_red(const P##_node *n) {                             \
+  return n && (n->parent_red & 1);                                            \
+}                                                                             \
+                                                                              \
+static inline void P##_set_parent(P##_node *n, P##_node *parent) {            \
+  n->parent_red = (uintptr_t)parent | (n->parent_red & 1);                    \
+}                                                                             \
+                                                                              \
+static inline void P##_set_red(P##_node *n, int red) {                        \
+  n->parent_red = (n->parent_red & ~(uintptr_t)1) | (uintptr_t)(red != 0);    \
+}                                                                             \
+                                                                              \
+static inline P##_tree *P##_new(void) {                                       \
+  return (P##_tree *)calloc(1, sizeof(P##_tree));                             \
+}                                                                             \
+                                                                              \
+static inline void P##_rotate_left(P##_tree *t, P##_node *node) {             \
+  P##_node *r = node->right, *p = P##_parent(node);                           \
+  node->right = r->left;                                                      \
+  if (r->left)                                                                \
+    P##_set_parent(r->left, node);                                            \
+  P##_set_parent(r, p);                                                       \
+  if (!p)                                                                     \
+    t->root = r;                                                              \
+  else if (node == p->left)                                                   \
+    p->left = r;                                                              \
+  else                                                                        \
+    p->right = r;                                                             \
+  r->left = node;                                                             \
+  P##_set_parent(node, r);                                                    \
+}                                                                             \
+                                                                              \
+static inline void P##_rotate_right(P##_tree *t, P##_node *node) {            \
+  P##_node *l = node->left, *p = P##_parent(node);                            \
+  node->left = l->right;                                                      \
+  if (l->right)                                                               \
+    P##_set_parent(l->right, node);                                           \
+  P##_set_parent(l, p);                                                       \
+  if (!p)                                                                     \
+    t->root = l;                                                              \
+  else if (node == p->right)                                                  \
+    p->right = l;                                                             \
+  else                                                                        \
+    p->left = l;                                                              \
+  l->right = node;                                                            \
+  P##_set_parent(node, l);                                                    \
+}                                                                             \
+                                                                              \
+static inline P##_node *P##_link(P##_tree *t, P##_node *parent, int left,     \
+                                 K key, V value) {                            \
+  P##_node *node = P##_alloc_node(t);                                         \
+  if (!node)                                                                  \
+    return NULL;                                                              \
+  node->key = key;                                                            \
+  node->value = value;                                                        \
+  node->parent_red = (uintptr_t)parent | 1;                                   \
+  node->left = node->right = NULL;                                            \
+  if (!parent)                                                                \
+    t->root = node;                                                           \
+  else if (left)                                                              \
+    parent->left = node;                                                      \
+  else                                                                        \
+    parent->right = node;                                                     \
+                                                                              \
+  P##_node *x = node, *p;                                                     \
+  while ((p = P##_parent(x)) && P##_is_red(p)) {                              \
+    P##_node *g = P##_parent(p);  /* 부모가 빨강이면 루트가 아니니 g가 있음 */                \
+    if (p == g->left) {                                                       \
+      P##_node *u = g->right;                                                 \
+      if (P##_is_red(u)) {                                                    \
+        P##_set_red(p, 0);                                                    \
+        P##_set_red(u, 0);                                                    \
+        P##_set_red(g, 1);                                                    \
+        x = g;                                                                \
+        continue;                                                             \
+      }                                                                       \
+      if (x == p->right) {                                                    \
+        P##_rotate_left(t, p);                                                \
+        x = p;                                                                \
+        p = P##_parent(x);                                                    \
+      }                                                                       \
+      P##_set_red(p, 0);                                                      \
+      P##_set_red(g, 1);                                                      \
+      P##_rotate_right(t, g);                                                 \
+    } else {                                                                  \
+      P##_node *u = g->left;                                                  \
+      if (P##_is_red(u)) {                                                    \
+        P##_set_red(p, 0);                                                    \
+        P##_set_red(u, 0);                                                    \
+        P##_set_red(g, 1);                                                    \
+        x = g;                                                                \
+        continue;                                                             \
+      }                                                                       \
+      if (x == p->left) {                                                     \
+        P##_rotate_right(t, p);                                               \
+        x = p;                                                                \
+        p = P##_parent(x);                                                    \
+      }                                                                       \
+      P##_set_red(p, 0);                                                      \
+      P##_set_red(g, 1);                                                      \
+      P##_rotate_left(t, g);                                                  \
+    }                                                                         \
+  }                                                                           \
+  P##_set_red(t->root, 0);                                                    \
+  return node;                                                                \
+}                                                                             \
+                                                                              \
+static inline P##_node *P##_insert(P##_tree *t, K key, V value) {             \
+  P##_node *parent = NULL, *cur = t->root;                                    \
+  int left = 0;                                                               \
+  while (cur) {                                                               \
+    parent = cur;                                                             \
+    left = CMP(cur->key, key) > 0;                                            \
+    cur = left ? cur->left : cur->right;                                      \
+  }                                                                           \
+  return P##_link(t, parent, left, key, value);                               \
+}                                                                             \
+                                                                              \
+static inline P##_node *P##_put(P##_tree *t, K key, V value) {                \
+  P##_node *parent = NULL, *cur = t->root;                                    \
+  int left = 0;                                                               \
+  while (cur) {                                                               \
+    int c = CMP(cur->key, key);                                               \
+    if (c == 0) {                                                             \
+      cur->value = value;                                                     \
+      return cur;                                                             \
+    }                                                                         \
+    parent = cur;                                                             \
+    left = c > 0;                                                             \
+    cur = left ? cur->left : cur->right;                                      \
+  }                                                                           \
+  return P##_link(t, parent, left, key, value);                               \
+}                                                                             \
+                                                                              \
+static inline P##_node *P##_find(const P##_tree *t, K key) {                  \
+  P##_node *cur = t->root;                                                    \
+  while (cur) {                                                               \
+    int c = CMP(cur->key, key);                                               \
+    if (c == 0)                                                               \
+      return cur;                                                             \
+    cur = c > 0 ? cur->left : cur->right;                                     \
+  }                                                                           \
+  return NULL;                                                                \
+}                                                                             \
+                                                                              \
+static inline P##_node *P##_lower_bound(const P##_tree *t, K key) {           \
+  P##_node *cur = t->root, *result = NULL;                                    \
+  while (cur) {                                                               \
+    if (CMP(cur->key, key) >= 0) {                                            \
+      result = cur;                                                           \
+      cur = cur->left;                                                        \
+    } else                                                                    \
+      cur = cur->right;                                                       \
+  }                                                                           \
+  return result;                                                              \
+}                                                                             \
+                                                                              \
+static inline P##_node *P##_upper_bound(const P##_tree *t, K key) {           \
+  P##_node *cur = t->root, *result = NULL;                                    \
+  while (cur) {                                                               \
+    if (CMP(cur->key, key) > 0) {                                             \
+      result = cur;                                                           \
+      cur = cur->left;                                                        \
+    } else                                                                    \
+      cur = cur->right;                                                       \
+  }                                                                           \
+  return result;                                                              \
+}                                                                             \
+                                                                              \
+static inline P##_node *P##_min(const P##_tree *t) {                          \
+  P##_node *cur = t->root;                                                    \
+  while (cur && cur->left)                                                    \
+    cur = cur->left;                                                          \
+  return cur;                                                                 \
+}                                                                             \
+                                                                              \
+static inline P##_node *P##_max(const P##_tree *t) {                          \
+  P##_node *cur = t->root;                                                    \
+  while (cur && cur->right)                                                   \
+    cur = cur->right;                                                         \
+  return cur;                                                                 \
+}                                                                             \
+                                                                              \
+static inline P##_node *P##_next(const P##_tree *t, P##_node *p) {            \
+  (void)t;                                                                    \
+  if (p->right) {                                                             \
+    p = p->right;                                                             \
+    while (p->left)                                                           \
+      p = p->left;                                                            \
+    return p;                                                                 \
+  }                                                                           \
+  P##_node *parent = P##_parent(p);                                           \
+  while (parent && p == parent->right) {                                      \
+    p = parent;                                                               \
+    parent = P##_parent(p);                                                   \
+  }                                                                           \
+  return parent;                                                              \
+}                                                                             \
+                                                                              \
+static inline P##_node *P##_prev(const P##_tree *t, P##_node *p) {            \
+  (void)t;                                                                    \
+  if (p->left) {                                                              \
+    p = p->left;                                                              \
+    while (p->right)                                                          \
+      p = p->right;                                                           \
+    return p;                                                                 \
+  }                                                                           \
+  P##_node *parent = P##_parent(p);                                           \
+  while (parent && p == parent->left) {                                       \
+    p = parent;                                                               \
+    parent = P##_parent(p);                                                   \
+  }                                                                           \
+  return parent;                                                              \
+}                                                                             \
+                                                                              \
+static inline void P##_transplant(P##_tree *t, P##_node *u, P##_node *v) {    \
+  P##_node *up = P##_parent(u);                                               \
+  if (!up)                                                                    \
+    t->root = v;                                                              \
+  else if (u == up->left)                                                     \
+    up->left = v;                                                             \
+  else                                                                        \
+    up->right = v;                                                            \
+  if (v)                                                                      \
+    P##_set_parent(v, up);                                                    \
+}                                                                             \
+                                                                              \
+/* x가 NULL일 수 있어 부모 xp를 따로 들고 다님 */                                           \
+static inline void P##_erase_fix_up(P##_tree *t, P##_node *x, P##_node *xp) { \
+  while (x != t->root && !P##_is_red(x)) {                                    \
+    if (x == xp->left) {                                                      \
+      P##_node *w = xp->right;                                                \
+      if (P##_is_red(w)) {                                                    \
+        P##_set_red(w, 0);                                                    \
+        P##_set_red(xp, 1);                                                   \
+        P##_rotate_left(t, xp);                                               \
+        w = xp->right;                                                        \
+      }                                                                       \
+      if (!P##_is_red(w->left) && !P##_is_red(w->right)) {                    \
+        P##_set_red(w, 1);                                                    \
+        x = xp;                                                               \
+        xp = P##_parent(x);                                                   \
+      } else {                                                                \
+        if (!P##_is_red(w->right)) {                                          \
+          P##_set_red(w->left, 0);                                            \
+          P##_set_red(w, 1);                                                  \
+          P##_rotate_right(t, w);                                             \
+          w = xp->right;                                                      \
+        }                                                                     \
+        P##_set_red(w, P##_is_red(xp));                                       \
+        P##_set_red(xp, 0);                                                   \
+        P##_set_red(w->right, 0);                                             \
+        P##_rotate_left(t, xp);                                               \
+        x = t->root;                                                          \
+      }                                                                       \
+    } else {                                                                  \
+      P##_node *w = xp->left;                                                 \
+      if (P##_is_red(w)) {                                                    \
+        P##_set_red(w, 0);                                                    \
+        P##_set_red(xp, 1);                                                   \
+        P##_rotate_right(t, xp);                                              \
+        w = xp->left;                                                         \
+      }                                                                       \
+      if (!P##_is_red(w->left) && !P##_is_red(w->right)) {                    \
+        P##_set_red(w, 1);                                                    \
+        x = xp;                                                               \
+        xp = P##_parent(x);                                                   \
+      } else {                                                                \
+        if (!P##_is_red(w->left)) {                                           \
+          P##_set_red(w->right, 0);                                           \
+          P##_set_red(w, 1);                                                  \
+          P##_rotate_left(t, w);                                              \
+          w = xp->left;                                                       \
+        }                                                                     \
+        P##_set_red(w, P##_is_red(xp));                                       \
+        P##_set_red(xp, 0);                                                   \
+        P##_set_red(w->left, 0);                                              \
+        P##_rotate_right(t, xp);                                              \
+        x = t->root;                                                          \
+      }                                                                       \
+    }                                                                         \
+  }                                                                           \
+  if (x)                                                                      \
+    P##_set_red(x, 0);                                                        \
+}                                                                             \
+                                                                              \
+static inline int P##_erase(P##_tree *t, P##_node *p) {                       \
+  if (!p)                                                                     \
+    return 0;                                                                 \
+  P##_node *x, *xp, *y = p;                                                   \
+  int y_red = P##_is_red(y);                                                  \
+  if (!p->left) {                                                             \
+    x = p->right;                                                             \
+    xp = P##_parent(p);                                                       \
+    P##_transplant(t, p, x);                                                  \
+  } else if (!p->right) {                                                     \
+    x = p->left;                                                              \
+    xp = P##_parent(p);                                                       \
+    P##_transplant(t, p, x);                                                  \
+  } else {                                                                    \
+    y = p->right;                                                             \
+    while (y->left)                                                           \
+      y = y->left;                                                            \
+    y_red = P##_is_red(y);                                                    \
+    x = y->right;                                                             \
+    if (P##_parent(y) == p)                                                   \
+      xp = y;                                                                 \
+    else {                                                                    \
+      xp = P##_parent(y);                                                     \
+      P##_transplant(t, y, y->right);                                         \
+      y->right = p->right;                                                    \
+      P##_set_parent(y->right, y);                                            \
+    }                                                                         \
+    P##_transplant(t, p, y);                                                  \
+    y->left = p->left;                                                        \
+    P##_set_parent(y->left, y);                                               \
+    P##_set_red(y, P##_is_red(p));                                            \
+  }                                                                           \
+  if (!y_red)                                                                 \
+    P##_erase_fix_up(t, x, xp);                                               \
+  P##_free_node(t, p);                                                        \
+  return 1;                                                                   \
+}
+
+#endif  // _RBTREE_GEN_H_
@@ -0,0 +1,150 @@
+#include <assert.h>
+#include <bptree.h>
+#include <rbtree.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Structure constraints
+// 1. All leaves are at the same depth and linked left to right.
+// 2. Every node but the root is at least half full.
+// 3. Keys in child[i] <= keys[i] <= keys in child[i + 1].
+
+static const bptree_leaf *next_leaf;
+static size_t leaf_keys;
+
+static void check_node(const void *node, int level, bool is_root,
+                       const key_t *lo, const key_t *hi) {
+  if (level == 0) {
+    const bptree_leaf *leaf = (const bptree_leaf *)node;
+    assert(is_root || leaf->n >= BPTREE_LEAF_KEYS / 2);
+    assert(leaf->n <= BPTREE_LEAF_KEYS);
+    assert(leaf == next_leaf);
+    for (int i = 0; i < leaf->n; i++) {
+      assert(i == 0 || leaf->keys[i - 1] <= leaf->keys[i]);
+      assert(lo == NULL || *lo <= leaf->keys[i]);
+      assert(hi == NULL || leaf->keys[i] <= *hi);
+    }
+    leaf_keys += leaf->n;
+    next_leaf = leaf->next;
+    return;
+  }
+  const bptree_inner *in = (const bptree_inner *)node;
+  assert(in->n >= (is_root ? 1 : BPTREE_INNER_KEYS / 2));
+  assert(in->n <= BPTREE_INNER_KEYS);
+  for (int i = 0; i <= in->n; i++) {
+    const key_t *clo = i == 0 ? lo : &in->keys[i - 1];
+    const key_t *chi = i == in->n ? hi : &in->keys[i];
+    assert(clo == NULL || chi == NULL || *clo <= *chi);
+    check_node(in->child[i], level - 1, false, clo, chi);
+  }
+}
+
+static void check_bptree(const bptree *t) {
+  void *node = t->root;
+  for (int level = t->height; level > 0; level--) {
+    node = ((bptree_inner *)node)->child[0];
+  }
+  next_leaf = (const bptree_leaf *)node;
+  leaf_keys = 0;
+  check_node(t->root, t->height, true, NULL, NULL);
+  assert(next_leaf == NULL);
+  assert(leaf_keys == t->size);
+}
+
+// bptree should hold the same multiset as rbtree through the same inserts
+// and erases
+void test_matches_rbtree(const size_t n, const int key_range,
+                         const unsigned int seed) {
+  srand(seed);
+  bptree *b = new_bptree();
+  rbtree *t = new_rbtree();
+  key_t *arr = calloc(n, sizeof(key_t));
+  key_t *res = calloc(n, sizeof(key_t));
+  assert(b != NULL && t != NULL && arr != NULL && res != NULL);
+  assert(bptree_min(b) == NULL && bptree_max(b) == NULL);
+  assert(bptree_find(b, 0) == NULL && bptree_erase(b, 0) == 0);
+
+  for (size_t i = 0; i < n; i++) {
+    const key_t key = rand() % key_range - key_range / 2;
+    assert(bptree_insert(b, key) == 1);
+    rbtree_insert(t, key);
+    if (i % 3 == 0) {
+      const key_t victim = rand() % key_range - key_range / 2;
+      node_t *p = rbtree_find(t, victim);
+      assert(bptree_erase(b, victim) == (p != NULL));
+      if (p != NULL) {
+        rbtree_erase(t, p);
+      }
+    }
+    if (i % 5000 == 0) {
+      check_bptree(b);
+    }
+  }
+  check_bptree(b);
+
+  const int count = rbtree_to_array(t, arr, n);
+  assert(b->size == (size_t)count);
+  assert(bptree_to_array(b, res, n) == count);
+  for (int i = 0; i < count; i++) {
+    assert(res[i] == arr[i]);
+  }
+  assert(*bptree_min(b) == arr[0] && *bptree_max(b) == arr[count - 1]);
+
+  for (key_t key = -key_range / 2 - 1; key <= key_range / 2; key++) {
+    const key_t *p = bptree_find(b, key);
+    assert((p == NULL) == (rbtree_find(t, key) == NULL));
+    assert(p == NULL || *p == key);
+    const int m = bptree_range(b, key, key + 7, res, n);
+    assert(m == rbtree_range(t, key, key + 7, arr, n));
+    for (int i = 0; i < m; i++) {
+      assert(res[i] == arr[i]);
+    }
+  }
+
+  // erase everything; the root should shrink back to a single leaf
+  const int total = rbtree_to_array(t, arr, n);
+  for (int i = total - 1; i >= 0; i--) {
+    assert(bptree_erase(b, arr[i]) == 1);
+    if (i % 1000 == 0) {
+      check_bptree(b);
+    }
+  }
+  assert(b->size == 0 && b->height == 0);
+  assert(bptree_min(b) == NULL);
+
+  free(arr);
+  free(res);
+  delete_rbtree(t);
+  delete_bptree(b);
+}
+
+// ascending and descending inserts split at the tree edges
+void test_sequential(const int n) {
+  bptree *b = new_bptree();
+  for (int i = 0; i < n; i++) {
+    assert(bptree_insert(b, i) == 1);
+    assert(bptree_insert(b, -i - 1) == 1);
+  }
+  check_bptree(b);
+  assert(*bptree_min(b) == -n && *bptree_max(b) == n - 1);
+  key_t *res = calloc(2 * n, sizeof(key_t));
+  assert(bptree_to_array(b, res, 2 * n) == 2 * n);
+  for (int i = 0; i < 2 * n; i++) {
+    assert(res[i] == i - n);
+  }
+  assert(bptree_to_array(b, res, 5) == 5);
+  for (int i = 0; i < n; i += 2) {
+    assert(bptree_erase(b, i) == 1);
+  }
+  check_bptree(b);
+  free(res);
+  delete_bptree(b);
+}
+
+int main(void) {
+  test_sequential(10000);
+  test_matches_rbtree(60000, 1000, 43);     // many duplicates
+  test_matches_rbtree(60000, 1 << 20, 47);  // mostly distinct
+  printf("Passed all tests!\n");
+}
@@ -0,0 +1,171 @@
+#include <assert.h>
+#include <prbtree.h>
+#include <pthread.h>
+#include <rbtree.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Same color constraints as test-rbtree.c, plus every node is referenced
+static int black_height(const prbtree_node *p) {
+  if (p == NULL) {
+    return 1;
+  }
+  assert(__atomic_load_n(&p->refs, __ATOMIC_RELAXED) >= 1);
+  if (p->color == RBTREE_RED) {
+    assert(p->left == NULL || p->left->color == RBTREE_BLACK);
+    assert(p->right == NULL || p->right->color == RBTREE_BLACK);
+  }
+  if (p->left != NULL) {
+    assert(p->left->key <= p->key);
+  }
+  if (p->right != NULL) {
+    assert(p->right->key >= p->key);
+  }
+  const int l = black_height(p->left);
+  const int r = black_height(p->right);
+  assert(l == r);
+  return l + (p->color == RBTREE_BLACK ? 1 : 0);
+}
+
+static void check_prbtree(const prbtree *t, const key_t *expected, const size_t n) {
+  assert(t->root == NULL || t->root->color == RBTREE_BLACK);
+  black_height(t->root);
+  assert(prbtree_size(t) == n);
+  key_t *res = calloc(n + 1, sizeof(key_t));
+  assert(prbtree_to_array(t, res, n + 1) == n);
+  assert(memcmp(res, expected, n * sizeof(key_t)) == 0);
+  free(res);
+}
+
+// Random inserts and erases against rbtree.c. Snapshots taken along the way
+// must keep their contents while the live tree (and the snapshots themselves)
+// keep changing.
+#define SNAPSHOTS 6
+
+void test_prbtree_snapshots(const size_t n, const unsigned int seed) {
+  srand(seed);
+  prbtree *t = new_prbtree();
+  rbtree *ref = new_rbtree();
+  prbtree *snaps[SNAPSHOTS];
+  key_t *saved[SNAPSHOTS];
+  size_t saved_n[SNAPSHOTS];
+  key_t *arr = calloc(n, sizeof(key_t));
+  assert(t != NULL && ref != NULL && arr != NULL);
+  assert(!prbtree_erase(t, 0) && !prbtree_find(t, 0));
+
+  int taken = 0;
+  for (size_t i = 0; i < n; i++) {
+    const key_t key = rand() % (int)(n / 4);
+    assert(prbtree_insert(t, key));
+    rbtree_insert(ref, key);
+    if (i % 3 == 0) {
+      const key_t victim = rand() % (int)(n / 4);
+      node_t *p = rbtree_find(ref, victim);
+      assert(prbtree_erase(t, victim) == (p != NULL));
+      if (p != NULL) {
+        rbtree_erase(ref, p);
+      }
+    }
+    if (taken < SNAPSHOTS && i % (n / SNAPSHOTS) == n / SNAPSHOTS / 2) {
+      snaps[taken] = prbtree_snapshot(t);
+      saved_n[taken] = rbtree_to_array(ref, arr, n);
+      saved[taken] = calloc(saved_n[taken] + 1, sizeof(key_t));
+      memcpy(saved[taken], arr, saved_n[taken] * sizeof(key_t));
+      check_prbtree(snaps[taken], saved[taken], saved_n[taken]);
+      taken++;
+    }
+    if (i % 1000 == 0) {
+      black_height(t->root);
+    }
+  }
+  assert(taken == SNAPSHOTS);
+  check_prbtree(t, arr, rbtree_to_array(ref, arr, n));
+  for (int s = 0; s < SNAPSHOTS; s++) {
+    check_prbtree(snaps[s], saved[s], saved_n[s]);
+  }
+
+  // writing to a snapshot leaves the live tree and the other snapshots alone
+  const size_t live_n = rbtree_to_array(ref, arr, n);
+  for (size_t i = 0; i < saved_n[1]; i++) {
+    assert(prbtree_erase(snaps[1], saved[1][i]));
+  }
+  assert(prbtree_insert(snaps[1], -5));
+  assert(snaps[1]->root->key == -5 && prbtree_size(snaps[1]) == 1);
+  check_prbtree(t, arr, live_n);
+  check_prbtree(snaps[0], saved[0], saved_n[0]);
+  check_prbtree(snaps[2], saved[2], saved_n[2]);
+
+  // release in an odd order; the live tree still works afterwards
+  delete_prbtree(snaps[3]);
+  delete_prbtree(snaps[0]);
+  while (prbtree_size(t) > 0) {
+    assert(prbtree_erase(t, t->root->key));
+  }
+  assert(t->root == NULL);
+  for (int s = 1; s < SNAPSHOTS; s++) {
+    if (s != 3) {
+      if (s != 1) {
+        check_prbtree(snaps[s], saved[s], saved_n[s]);
+      }
+      delete_prbtree(snaps[s]);
+    }
+  }
+  for (int s = 0; s < SNAPSHOTS; s++) {
+    free(saved[s]);
+  }
+  assert(prbtree_insert(t, 1) && prbtree_find(t, 1));
+
+  free(arr);
+  delete_rbtree(ref);
+  delete_prbtree(t);
+}
+
+// export threads read and release snapshots while the writer keeps going
+typedef struct {
+  prbtree *snap;
+  key_t *expected;
+  size_t n;
+} export_job;
+
+static void *export_snapshot(void *arg) {
+  export_job *job = arg;
+  check_prbtree(job->snap, job->expected, job->n);
+  delete_prbtree(job->snap);
+  return NULL;
+}
+
+void test_prbtree_export_threads(const size_t n) {
+  prbtree *t = new_prbtree();
+  key_t *expected[4];
+  pthread_t threads[4];
+  export_job jobs[4];
+  assert(t != NULL);
+  for (int round = 0; round < 4; round++) {
+    for (size_t i = 0; i < n; i++) {
+      assert(prbtree_insert(t, (key_t)((i * 7919 + round) % n)));
+    }
+    jobs[round].n = prbtree_size(t);
+    expected[round] = calloc(jobs[round].n, sizeof(key_t));
+    prbtree_to_array(t, expected[round], jobs[round].n);
+    jobs[round].expected = expected[round];
+    jobs[round].snap = prbtree_snapshot(t);
+    assert(pthread_create(&threads[round], NULL, export_snapshot, &jobs[round]) == 0);
+    // keep writing (erase half of what was just added) while it exports
+    for (size_t i = 0; i < n; i += 2) {
+      assert(prbtree_erase(t, (key_t)((i * 7919 + round) % n)));
+    }
+  }
+  for (int round = 0; round < 4; round++) {
+    pthread_join(threads[round], NULL);
+    free(expected[round]);
+  }
+  black_height(t->root);
+  delete_prbtree(t);
+}
+
+int main(void) {
+  test_prbtree_snapshots(20000, 59);
+  test_prbtree_export_threads(5000);
+  printf("Passed all tests!\n");
+}
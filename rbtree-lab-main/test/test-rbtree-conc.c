@@ -0,0 +1,117 @@
+#include <assert.h>
+#include <pthread.h>
+#include <rbtree.h>
+#include <rbtree_conc.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// single thread: same answers as a plain rbtree
+void test_conc_matches_rbtree(const size_t n, const unsigned int seed) {
+  srand(seed);
+  rbtree_conc *c = new_rbtree_conc();
+  rbtree *t = new_rbtree();
+  assert(c != NULL && t != NULL);
+  key_t out;
+  assert(!rbtree_conc_find(c, 0) && !rbtree_conc_lower_bound(c, 0, &out));
+
+  for (size_t i = 0; i < n; i++) {
+    const key_t key = rand() % (int)(n / 2);
+    assert(rbtree_conc_insert(c, key));
+    rbtree_insert(t, key);
+    if (i % 3 == 0) {
+      const key_t victim = rand() % (int)(n / 2);
+      node_t *p = rbtree_find(t, victim);
+      assert(rbtree_conc_erase(c, victim) == (p != NULL));
+      if (p != NULL) {
+        rbtree_erase(t, p);
+      }
+    }
+  }
+  for (key_t key = -1; key <= (key_t)(n / 2); key++) {
+    assert(rbtree_conc_find(c, key) == (rbtree_find(t, key) != NULL));
+    node_t *lb = rbtree_lower_bound(t, key);
+    assert(rbtree_conc_lower_bound(c, key, &out) == (lb != NULL));
+    assert(lb == NULL || out == lb->key);
+  }
+  delete_rbtree(t);
+  delete_rbtree_conc(c);
+}
+
+// Readers run while a writer churns odd keys. Even keys 0..2*EVENS-2 stay put,
+// so every even key must be found, and the lower bound of an odd key is the
+// key itself or the even key right after it.
+#define EVENS 2000
+#define READERS 4
+
+static int writer_done;
+
+static void *churn_odd_keys(void *arg) {
+  rbtree_conc *c = arg;
+  unsigned int seed = 5;
+  for (int round = 0; round < 20000; round++) {
+    const key_t key = (rand_r(&seed) % EVENS) * 2 + 1;
+    assert(rbtree_conc_insert(c, key));
+    if (round % 2) {
+      rbtree_conc_erase(c, (rand_r(&seed) % EVENS) * 2 + 1);
+    }
+  }
+  // erase whatever odd keys are left
+  for (key_t key = 1; key < 2 * EVENS; key += 2) {
+    while (rbtree_conc_erase(c, key)) {
+    }
+  }
+  __atomic_store_n(&writer_done, 1, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+static void *check_reads(void *arg) {
+  rbtree_conc *c = arg;
+  unsigned int seed = (unsigned int)(size_t)pthread_self();
+  size_t reads = 0;
+  while (!__atomic_load_n(&writer_done, __ATOMIC_ACQUIRE) || reads < 10000) {
+    const key_t even = (rand_r(&seed) % EVENS) * 2;
+    assert(rbtree_conc_find(c, even));
+    const key_t odd = even + 1;
+    key_t out;
+    if (rbtree_conc_lower_bound(c, odd, &out)) {
+      assert(out == odd || out == odd + 1);
+    } else {
+      assert(odd + 1 >= 2 * EVENS);
+    }
+    reads++;
+  }
+  return NULL;
+}
+
+void test_conc_readers_during_writes(void) {
+  rbtree_conc *c = new_rbtree_conc();
+  assert(c != NULL);
+  for (key_t key = 0; key < 2 * EVENS; key += 2) {
+    assert(rbtree_conc_insert(c, key));
+  }
+  writer_done = 0;
+  pthread_t writer, readers[READERS];
+  for (int i = 0; i < READERS; i++) {
+    assert(pthread_create(&readers[i], NULL, check_reads, c) == 0);
+  }
+  assert(pthread_create(&writer, NULL, churn_odd_keys, c) == 0);
+  pthread_join(writer, NULL);
+  for (int i = 0; i < READERS; i++) {
+    pthread_join(readers[i], NULL);
+  }
+
+  // only the even keys are left
+  key_t *arr = calloc(EVENS + 1, sizeof(key_t));
+  assert(rbtree_to_array(c->tree, arr, EVENS + 1) == EVENS);
+  for (int i = 0; i < EVENS; i++) {
+    assert(arr[i] == 2 * i);
+  }
+  free(arr);
+  delete_rbtree_conc(c);
+}
+
+int main(void) {
+  test_conc_matches_rbtree(20000, 53);
+  test_conc_readers_during_writes();
+  printf("Passed all tests!\n");
+}
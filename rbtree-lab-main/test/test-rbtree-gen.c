@@ -0,0 +1,237 @@
+#include <assert.h>
+#include <rbtree.h>
+#include <rbtree_gen.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+RBTREE_DEFINE(imap, int, int, RBTREE_CMP_NUM)
+RBTREE_DEFINE(u64map, uint64_t, uint64_t, RBTREE_CMP_NUM)
+RBTREE_DEFINE(smap, const char *, int, RBTREE_CMP_STR)
+RBTREE_DEFINE_COMPACT(cmap, int, int, RBTREE_CMP_NUM)
+
+// Same color constraints as test-rbtree.c, on the generated int tree
+static int black_height(const imap_node *p, const imap_node *nil) {
+  if (p == nil) {
+    return 1;
+  }
+  if (p->red) {
+    assert(!p->left->red && !p->right->red);
+  }
+  const int l = black_height(p->left, nil);
+  const int r = black_height(p->right, nil);
+  assert(l == r);
+  return l + (p->red ? 0 : 1);
+}
+
+static void check_imap(const imap_tree *t) {
+  assert(!t->root->red);
+  black_height(t->root, t->nil);
+}
+
+// the generated int tree should hold the same keys as rbtree.c after the
+// same inserts and erases
+void test_imap_matches_rbtree(const size_t n, const unsigned int seed) {
+  srand(seed);
+  imap_tree *g = imap_new();
+  rbtree *t = new_rbtree();
+  key_t *arr = calloc(n, sizeof(key_t));
+  assert(g != NULL && t != NULL && arr != NULL);
+
+  for (size_t i = 0; i < n; i++) {
+    const int key = rand() % (int)(n / 4);
+    imap_node *p = imap_insert(g, key, (int)i);
+    assert(p != NULL && p->key == key && p->value == (int)i);
+    rbtree_insert(t, key);
+    if (i % 3 == 0) {
+      const int victim = rand() % (int)(n / 4);
+      imap_node *q = imap_find(g, victim);
+      node_t *r = rbtree_find(t, victim);
+      assert((q == NULL) == (r == NULL));
+      if (q != NULL) {
+        assert(q->key == victim);
+        imap_erase(g, q);
+        rbtree_erase(t, r);
+      }
+    }
+  }
+  check_imap(g);
+
+  const int count = rbtree_to_array(t, arr, n);
+  int i = 0;
+  for (imap_node *p = imap_min(g); p != NULL; p = imap_next(g, p)) {
+    assert(i < count && p->key == arr[i]);
+    i++;
+  }
+  assert(i == count);
+  for (imap_node *p = imap_max(g); p != NULL; p = imap_prev(g, p)) {
+    assert(i > 0 && p->key == arr[i - 1]);
+    i--;
+  }
+
+  for (int key = -1; key <= (int)(n / 4); key++) {
+    imap_node *lb = imap_lower_bound(g, key);
+    node_t *rlb = rbtree_lower_bound(t, key);
+    assert((lb == NULL) == (rlb == NULL));
+    assert(lb == NULL || lb->key == rlb->key);
+    imap_node *ub = imap_upper_bound(g, key);
+    node_t *rub = rbtree_upper_bound(t, key);
+    assert((ub == NULL) == (rub == NULL));
+    assert(ub == NULL || ub->key == rub->key);
+  }
+
+  // erase everything, then the slab should hand the nodes out again
+  while (imap_min(g) != NULL) {
+    imap_erase(g, imap_min(g));
+  }
+  assert(g->root == g->nil);
+  assert(imap_insert(g, 7, 7) != NULL);
+  check_imap(g);
+
+  free(arr);
+  delete_rbtree(t);
+  imap_delete(g);
+}
+
+// put should keep one node per key and replace its value
+void test_u64_put(const size_t n) {
+  u64map_tree *t = u64map_new();
+  assert(t != NULL);
+  for (uint64_t i = 0; i < n; i++) {
+    const uint64_t key = (i * 0x9E3779B97F4A7C15ull) % (n / 2);
+    u64map_node *p = u64map_put(t, key << 32, i);
+    assert(p != NULL && p->key == key << 32 && p->value == i);
+  }
+  size_t count = 0;
+  uint64_t last = 0;
+  for (u64map_node *p = u64map_min(t); p != NULL; p = u64map_next(t, p)) {
+    assert(count == 0 || p->key > last);
+    last = p->key;
+    count++;
+  }
+  assert(count <= n / 2);
+  assert(u64map_find(t, 1) == NULL);
+  u64map_delete(t);
+}
+
+// string keys compare with strcmp, not by pointer
+void test_string_keys(void) {
+  static const char *words[] = {"pear", "apple", "fig", "kiwi", "banana",
+                                "cherry", "date", "grape", "lemon", "mango"};
+  const size_t n = sizeof(words) / sizeof(words[0]);
+  smap_tree *t = smap_new();
+  assert(t != NULL);
+  for (size_t i = 0; i < n; i++) {
+    assert(smap_put(t, words[i], (int)i) != NULL);
+  }
+  char buf[16] = "kiwi";
+  smap_node *p = smap_find(t, buf);
+  assert(p != NULL && p->value == 3 && p->key == words[3]);
+  assert(smap_find(t, "melon") == NULL);
+  assert(strcmp(smap_min(t)->key, "apple") == 0);
+  assert(strcmp(smap_max(t)->key, "pear") == 0);
+  assert(strcmp(smap_lower_bound(t, "c")->key, "cherry") == 0);
+  smap_erase(t, smap_find(t, "fig"));
+  assert(strcmp(smap_next(t, smap_find(t, "date"))->key, "grape") == 0);
+  smap_delete(t);
+}
+
+// compact tree: colour in the parent pointer, NULL children
+static int compact_black_height(const cmap_node *p, const cmap_node *parent) {
+  if (p == NULL) {
+    return 1;
+  }
+  assert(cmap_parent(p) == parent);
+  if (cmap_is_red(p)) {
+    assert(!cmap_is_red(p->left) && !cmap_is_red(p->right));
+  }
+  if (p->left != NULL) {
+    assert(p->left->key <= p->key);
+  }
+  if (p->right != NULL) {
+    assert(p->right->key >= p->key);
+  }
+  const int l = compact_black_height(p->left, p);
+  const int r = compact_black_height(p->right, p);
+  assert(l == r);
+  return l + (cmap_is_red(p) ? 0 : 1);
+}
+
+void test_compact_matches_rbtree(const size_t n, const unsigned int seed) {
+  if (sizeof(void *) == 8) {
+    assert(sizeof(imap_node) == 40 && sizeof(cmap_node) == 32);
+  }
+  srand(seed);
+  cmap_tree *g = cmap_new();
+  rbtree *t = new_rbtree();
+  key_t *arr = calloc(n, sizeof(key_t));
+  assert(g != NULL && t != NULL && arr != NULL);
+  assert(cmap_min(g) == NULL && cmap_find(g, 0) == NULL);
+
+  for (size_t i = 0; i < n; i++) {
+    const int key = rand() % (int)(n / 4);
+    cmap_node *p = cmap_insert(g, key, (int)i);
+    assert(p != NULL && p->key == key && p->value == (int)i);
+    rbtree_insert(t, key);
+    if (i % 3 == 0) {
+      const int victim = rand() % (int)(n / 4);
+      cmap_node *q = cmap_find(g, victim);
+      node_t *r = rbtree_find(t, victim);
+      assert((q == NULL) == (r == NULL));
+      if (q != NULL) {
+        cmap_erase(g, q);
+        rbtree_erase(t, r);
+      }
+    }
+    if (i % 1000 == 0) {
+      compact_black_height(g->root, NULL);
+    }
+  }
+  assert(!cmap_is_red(g->root));
+  compact_black_height(g->root, NULL);
+
+  const int count = rbtree_to_array(t, arr, n);
+  int i = 0;
+  for (cmap_node *p = cmap_min(g); p != NULL; p = cmap_next(g, p)) {
+    assert(i < count && p->key == arr[i]);
+    i++;
+  }
+  assert(i == count);
+  for (cmap_node *p = cmap_max(g); p != NULL; p = cmap_prev(g, p)) {
+    assert(i > 0 && p->key == arr[i - 1]);
+    i--;
+  }
+  for (int key = -1; key <= (int)(n / 4); key++) {
+    cmap_node *lb = cmap_lower_bound(g, key);
+    node_t *rlb = rbtree_lower_bound(t, key);
+    assert((lb == NULL) == (rlb == NULL));
+    assert(lb == NULL || lb->key == rlb->key);
+    cmap_node *ub = cmap_upper_bound(g, key);
+    node_t *rub = rbtree_upper_bound(t, key);
+    assert((ub == NULL) == (rub == NULL));
+    assert(ub == NULL || ub->key == rub->key);
+  }
+  assert(cmap_put(g, 3, -3)->value == -3);
+  assert(cmap_find(g, 3)->value == -3);
+
+  // erase from the root down to an empty tree
+  while (g->root != NULL) {
+    cmap_erase(g, g->root);
+    compact_black_height(g->root, NULL);
+  }
+  assert(cmap_insert(g, 7, 7) != NULL);
+
+  free(arr);
+  delete_rbtree(t);
+  cmap_delete(g);
+}
+
+int main(void) {
+  test_imap_matches_rbtree(20000, 37);
+  test_u64_put(10000);
+  test_string_keys();
+  test_compact_matches_rbtree(20000, 41);
+  printf("Passed all tests!\n");
+}
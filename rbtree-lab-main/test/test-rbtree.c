@@ -1,8 +1,10 @@
 #include <assert.h>
+#include <limits.h>
 #include <rbtree.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 // new_rbtree should return rbtree struct with null root node
 void test_init(void) {
@@ -367,6 +369,372 @@ void test_find_erase_rand(const size_t n, const unsigned int seed) {
   delete_rbtree(t);
 }
 
+// tree built from arr should hold exactly the sorted keys of arr
+static void check_tree_keys(const rbtree *t, const key_t *arr, const size_t n) {
+  key_t *sorted = calloc(n + 1, sizeof(key_t));
+  key_t *res = calloc(n + 1, sizeof(key_t));
+  for (size_t i = 0; i < n; i++) {
+    sorted[i] = arr[i];
+  }
+  qsort((void *)sorted, n, sizeof(key_t), comp);
+  assert(rbtree_to_array(t, res, n + 1) == n);
+  for (size_t i = 0; i < n; i++) {
+    assert(sorted[i] == res[i]);
+  }
+  free(sorted);
+  free(res);
+}
+
+// rbtree_from_sorted_array should build a valid rbtree for every size
+void test_from_sorted_array(const size_t max_n) {
+  key_t *arr = calloc(max_n, sizeof(key_t));
+  for (size_t n = 0; n <= max_n; n++) {
+    for (size_t i = 0; i < n; i++) {
+      arr[i] = (key_t)(i / 3) - (key_t)(n / 6);  // duplicates, negatives
+    }
+    rbtree *t = rbtree_from_sorted_array(arr, n);
+    assert(t != NULL);
+    test_color_constraint(t);
+    test_search_constraint(t);
+    check_tree_keys(t, arr, n);
+    if (n > 0) {
+      assert(rbtree_min(t)->key == arr[0]);
+      assert(rbtree_max(t)->key == arr[n - 1]);
+      node_t *p = rbtree_find(t, arr[n / 2]);
+      assert(p != NULL);
+      rbtree_erase(t, p);
+      test_color_constraint(t);
+    }
+    rbtree_insert(t, 0);
+    test_color_constraint(t);
+    delete_rbtree(t);
+  }
+  free(arr);
+}
+
+// rbtree_insert_bulk should merge unsorted keys into empty, small and large
+// trees
+void test_insert_bulk(const size_t n, const unsigned int seed) {
+  srand(seed);
+  key_t *arr = calloc(n, sizeof(key_t));
+  for (size_t i = 0; i < n; i++) {
+    arr[i] = rand() % (int)n - (int)n / 2;
+  }
+
+  const size_t cuts[] = {0, 1, n / 20, n / 2, n - 1};
+  for (size_t c = 0; c < sizeof(cuts) / sizeof(cuts[0]); c++) {
+    const size_t cut = cuts[c];
+    rbtree *t = new_rbtree();
+    insert_arr(t, arr, cut);
+    assert(rbtree_insert_bulk(t, arr + cut, n - cut) == n - cut);
+    test_color_constraint(t);
+    test_search_constraint(t);
+    check_tree_keys(t, arr, n);
+    for (size_t i = 0; i < n; i++) {
+      node_t *p = rbtree_find(t, arr[i]);
+      assert(p != NULL && p->key == arr[i]);
+      rbtree_erase(t, p);
+    }
+    assert(rbtree_min(t) == NULL);
+    delete_rbtree(t);
+  }
+
+  // a count the int return value can't hold is refused up front
+  rbtree *t = new_rbtree();
+  assert(rbtree_insert_bulk(t, arr, (size_t)INT_MAX + 1) == 0);
+  assert(rbtree_min(t) == NULL);
+  delete_rbtree(t);
+  free(arr);
+}
+
+// lower/upper bound, next/prev and range should agree with a sorted array
+static int count_visit(node_t *p, void *arg) {
+  int *limit = (int *)arg;
+  return --*limit == 0;
+}
+
+void test_iterate_range(const size_t n, const unsigned int seed) {
+  srand(seed);
+  key_t *arr = calloc(n, sizeof(key_t));
+  key_t *res = calloc(n, sizeof(key_t));
+  for (size_t i = 0; i < n; i++) {
+    arr[i] = rand() % (int)(n / 2);  // plenty of duplicates
+  }
+  rbtree *t = new_rbtree();
+  insert_arr(t, arr, n);
+  qsort((void *)arr, n, sizeof(key_t), comp);
+
+  // forward and backward walks visit every key in order
+  size_t i = 0;
+  for (node_t *p = rbtree_min(t); p != NULL; p = rbtree_next(t, p)) {
+    assert(i < n && p->key == arr[i]);
+    i++;
+  }
+  assert(i == n);
+  for (node_t *p = rbtree_max(t); p != NULL; p = rbtree_prev(t, p)) {
+    assert(i > 0 && p->key == arr[i - 1]);
+    i--;
+  }
+  assert(i == 0);
+
+  for (key_t key = -1; key <= (key_t)(n / 2); key++) {
+    size_t lo = 0, hi = 0;
+    while (lo < n && arr[lo] < key) lo++;
+    hi = lo;
+    while (hi < n && arr[hi] <= key) hi++;
+
+    node_t *lb = rbtree_lower_bound(t, key);
+    node_t *ub = rbtree_upper_bound(t, key);
+    assert(lo == n ? lb == NULL : lb != NULL && lb->key == arr[lo]);
+    assert(hi == n ? ub == NULL : ub != NULL && ub->key == arr[hi]);
+    // lower_bound is the first of the duplicates
+    assert(lb == NULL || rbtree_prev(t, lb) == NULL ||
+           rbtree_prev(t, lb)->key < key);
+
+    // [key, key + 10] compared with the sorted array
+    size_t end = lo;
+    while (end < n && arr[end] <= key + 10) end++;
+    assert(rbtree_range(t, key, key + 10, res, n) == end - lo);
+    for (size_t j = lo; j < end; j++) {
+      assert(res[j - lo] == arr[j]);
+    }
+    if (end - lo > 2) {
+      assert(rbtree_range(t, key, key + 10, res, 2) == 2);
+      int limit = 3;
+      assert(rbtree_range_visit(t, key, key + 10, count_visit, &limit) == 3);
+    }
+  }
+  assert(rbtree_range(t, 10, 5, res, n) == 0);
+
+  free(arr);
+  free(res);
+  delete_rbtree(t);
+}
+
+#ifdef RBTREE_ORDER_STAT
+// every subtree size should equal the number of nodes below it
+static size_t size_traverse(const node_t *p, const node_t *nil) {
+  if (p == nil) {
+    return 0;
+  }
+  const size_t size =
+      size_traverse(p->left, nil) + size_traverse(p->right, nil) + 1;
+  assert(p->size == size);
+  return size;
+}
+
+static void check_order_stat(const rbtree *t, key_t *arr, const size_t n) {
+  assert(size_traverse(t->root, t->nil) == n);
+  assert(rbtree_size(t) == n);
+  qsort((void *)arr, n, sizeof(key_t), comp);
+  for (size_t k = 0; k < n; k++) {
+    node_t *p = rbtree_select(t, k);
+    assert(p != NULL && p->key == arr[k]);
+    // rank counts the smaller keys, so it points at the first duplicate
+    const size_t rank = rbtree_rank(t, arr[k]);
+    assert(rank <= k && arr[rank] == arr[k]);
+    assert(rank == 0 || arr[rank - 1] < arr[k]);
+  }
+  assert(rbtree_select(t, n) == NULL);
+}
+
+// select/rank should stay correct through inserts, erases and bulk loads
+void test_order_stat(const size_t n, const unsigned int seed) {
+  srand(seed);
+  key_t *arr = calloc(n, sizeof(key_t));
+  for (size_t i = 0; i < n; i++) {
+    arr[i] = rand() % (int)n;
+  }
+  rbtree *t = new_rbtree();
+  assert(rbtree_size(t) == 0 && rbtree_select(t, 0) == NULL);
+  insert_arr(t, arr, n);
+  check_order_stat(t, arr, n);
+
+  // erase every other key (arr is sorted now), then put them back in bulk
+  size_t m = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (i % 2) {
+      node_t *p = rbtree_find(t, arr[i]);
+      assert(p != NULL);
+      rbtree_erase(t, p);
+    } else {
+      arr[m++] = arr[i];
+    }
+  }
+  check_order_stat(t, arr, m);
+  assert(rbtree_insert_bulk(t, arr, m) == m);
+  memcpy(arr + m, arr, m * sizeof(key_t));
+  check_order_stat(t, arr, 2 * m);
+  assert(rbtree_rank(t, -1) == 0);
+  assert(rbtree_rank(t, (key_t)n) == 2 * m);
+
+  free(arr);
+  delete_rbtree(t);
+}
+#endif
+
+// parent pointers must agree with the child links after split/join
+static void check_parents(const node_t *p, const node_t *nil) {
+  if (p == nil) {
+    return;
+  }
+  if (p->left != nil) {
+    assert(p->left->parent == p);
+  }
+  if (p->right != nil) {
+    assert(p->right->parent == p);
+  }
+  check_parents(p->left, nil);
+  check_parents(p->right, nil);
+}
+
+static void check_joined_tree(const rbtree *t, const key_t *arr, const size_t n) {
+  assert(t->root->parent == t->nil);
+  check_parents(t->root, t->nil);
+  test_color_constraint(t);
+  test_search_constraint(t);
+  check_tree_keys(t, arr, n);
+#ifdef RBTREE_ORDER_STAT
+  assert(size_traverse(t->root, t->nil) == n);
+#endif
+}
+
+void test_split_join(const size_t n, const unsigned int seed) {
+  srand(seed);
+  key_t *arr = calloc(n + 16, sizeof(key_t));
+  key_t *lo = calloc(n + 16, sizeof(key_t));
+  key_t *hi = calloc(n + 16, sizeof(key_t));
+  size_t m = n;
+  for (size_t i = 0; i < n; i++) {
+    arr[i] = rand() % (int)(n / 2);
+  }
+  rbtree *t = new_rbtree();
+  insert_arr(t, arr, n);
+
+  for (int round = 0; round < 8; round++) {
+    const key_t key = round == 0 ? -1 : rand() % (int)(n / 2 + 2);
+    rbtree *r = rbtree_split(t, key);
+    assert(r != NULL && r->nil == t->nil);
+    size_t nlo = 0, nhi = 0;
+    for (size_t i = 0; i < m; i++) {
+      if (arr[i] < key) {
+        lo[nlo++] = arr[i];
+      } else {
+        hi[nhi++] = arr[i];
+      }
+    }
+    check_joined_tree(t, lo, nlo);
+    check_joined_tree(r, hi, nhi);
+
+    // the split key sits between the halves, so it can be joined back
+    assert(rbtree_join(t, key, r));
+    assert(r->root == r->nil);
+    arr[m++] = key;
+    check_joined_tree(t, arr, m);
+    delete_rbtree(r);
+  }
+
+  // a tree from another pool is moved over when nothing else shares its pool
+  rbtree *big = new_rbtree();
+  rbtree_insert(big, (key_t)n);
+  rbtree_insert(big, (key_t)n + 5);
+  assert(!rbtree_join(big, (key_t)n + 1, t));  // keys out of order
+  assert(rbtree_join(t, (key_t)n, big));
+  arr[m++] = (key_t)n;
+  arr[m++] = (key_t)n;
+  arr[m++] = (key_t)n + 5;
+  check_joined_tree(t, arr, m);
+  assert(rbtree_insert(big, 3) != NULL && big->nil == t->nil);
+  delete_rbtree(big);
+
+  // ... but not when its pool is shared with another tree
+  rbtree *other = new_rbtree();
+  rbtree *half = rbtree_split(t, (key_t)n / 4);
+  assert(!rbtree_join(other, (key_t)-1, t));
+  assert(rbtree_join(t, (key_t)n / 4, half));
+  arr[m++] = (key_t)n / 4;
+  check_joined_tree(t, arr, m);
+  delete_rbtree(half);
+  delete_rbtree(other);
+
+  free(hi);
+  free(lo);
+  free(arr);
+  delete_rbtree(t);
+}
+
+// expected result of a set operation: t1's keys first, as documented in rbtree.h
+static size_t expect_set_op(const char op, const key_t *a, const size_t na,
+                            const key_t *b, const size_t nb, const size_t range,
+                            key_t *out) {
+  bool *in_a = calloc(range, sizeof(bool));
+  bool *in_b = calloc(range, sizeof(bool));
+  size_t m = 0;
+  for (size_t i = 0; i < na; i++) {
+    in_a[a[i]] = true;
+  }
+  for (size_t i = 0; i < nb; i++) {
+    in_b[b[i]] = true;
+  }
+  for (size_t i = 0; i < na; i++) {
+    if (op == 'u' || (op == 'i') == in_b[a[i]]) {
+      out[m++] = a[i];
+    }
+  }
+  for (size_t i = 0; op == 'u' && i < nb; i++) {
+    if (!in_a[b[i]]) {
+      out[m++] = b[i];
+    }
+  }
+  free(in_b);
+  free(in_a);
+  return m;
+}
+
+void test_set_operations(const size_t n, const unsigned int seed) {
+  static const char ops[] = {'u', 'i', 'd'};
+  srand(seed);
+  key_t *a = calloc(n, sizeof(key_t));
+  key_t *b = calloc(n, sizeof(key_t));
+  key_t *out = calloc(2 * n, sizeof(key_t));
+  for (int round = 0; round < 12; round++) {
+    const char op = ops[round % 3];
+    const int threads = round % 2 ? 4 : 1;
+    // mostly overlapping ranges, a few rounds with a small or empty b
+    const size_t na = n, nb = round < 9 ? n : (round - 9) * 50;
+    for (size_t i = 0; i < na; i++) {
+      a[i] = rand() % (int)n;
+    }
+    for (size_t i = 0; i < nb; i++) {
+      b[i] = rand() % (int)n + (round % 4 == 0 ? (int)n / 2 : 0);
+    }
+    const size_t m = expect_set_op(op, a, na, b, nb, n + n / 2, out);
+
+    rbtree *t1 = new_rbtree();
+    rbtree *t2 = round % 3 == 1 ? new_rbtree() : new_rbtree_shared(t1);
+    insert_arr(t1, a, na);
+    insert_arr(t2, b, nb);
+    int ok;
+    if (op == 'u') {
+      ok = rbtree_union(t1, t2, threads);
+    } else if (op == 'i') {
+      ok = rbtree_intersection(t1, t2, threads);
+    } else {
+      ok = rbtree_difference(t1, t2, threads);
+    }
+    assert(ok);
+    assert(t2->root == t2->nil);
+    check_joined_tree(t1, out, m);
+    // dropped nodes went back to the shared pool
+    insert_arr(t2, b, nb);
+    delete_rbtree(t1);
+    delete_rbtree(t2);
+  }
+  free(out);
+  free(b);
+  free(a);
+}
+
 int main(void) {
   test_init();
   test_insert_single(1024);
@@ -379,5 +747,13 @@ int main(void) {
   test_duplicate_values();
   test_multi_instance();
   test_find_erase_rand(10000, 17);
+  test_from_sorted_array(300);
+  test_insert_bulk(2000, 23);
+  test_iterate_range(2000, 29);
+  test_split_join(3000, 43);
+  test_set_operations(20000, 47);
+#ifdef RBTREE_ORDER_STAT
+  test_order_stat(3000, 31);
+#endif
   printf("Passed all tests!\n");
 }
\ No newline at end of file